@@ -6,9 +6,27 @@ CONSTRAINT_JSON=$1
 NUM_SAMPLES=$2
 RUN_DIR=$3 
 RANDOM_SEED=$4 
+SOLVER_FLOW=${SOLVER_FLOW:-solve}
+SOLVER_THREADS=${SOLVER_THREADS:-1}
+SOLVER_COUNT_ENGINE=${SOLVER_COUNT_ENGINE:-exact}
+SOLVER_CACHE_DIR=${SOLVER_CACHE_DIR:-}
+SOLVER_OPTIONS=(--threads "$SOLVER_THREADS" --count-engine "$SOLVER_COUNT_ENGINE")
+if [ -n "$SOLVER_CACHE_DIR" ]; then
+    SOLVER_OPTIONS+=(--cache-dir "$SOLVER_CACHE_DIR")
+fi
 
 mkdir -p "$RUN_DIR"
 
+FINAL_RESULT_JSON="$RUN_DIR/result.json"
+
+if [ "$SOLVER_FLOW" == "solve" ]; then
+    ./build/MySolver solve "$CONSTRAINT_JSON" "$NUM_SAMPLES" "$FINAL_RESULT_JSON" "$RANDOM_SEED" "${SOLVER_OPTIONS[@]}"
+    exit 0
+elif [ "$SOLVER_FLOW" == "bdd" ]; then
+    ./build/MySolver json-to-bdd "$CONSTRAINT_JSON" "$NUM_SAMPLES" "$FINAL_RESULT_JSON" "$RANDOM_SEED" "${SOLVER_OPTIONS[@]}"
+    exit 0
+fi
+
 INPUT_JSON_BASENAME=$(basename "$CONSTRAINT_JSON" .json) 
 PARENT_DIR=$(basename "$(dirname "$CONSTRAINT_JSON")")
 
@@ -20,8 +38,6 @@ else
     OUTPUT_AIG_FILE="$RUN_DIR/${INPUT_JSON_BASENAME}.aig"
 fi
 
-FINAL_RESULT_JSON="$RUN_DIR/result.json"
-./build/MySolver json-to-v "$CONSTRAINT_JSON" "$RUN_DIR"
 YOSYS_EXECUTABLE=/root/sv-sampler-lab/yosys/yosys
 YOSYS_SCRIPT_CONTENT="
 read_verilog \"${GENERATED_V_FILE}\";
@@ -30,8 +46,21 @@ abc;
 aigmap;
 opt;
 clean;
-write_aiger -ascii \"${OUTPUT_AIG_FILE}\";
+write_aiger \"${OUTPUT_AIG_FILE}\";
 "
 
+if [ -n "$SOLVER_CACHE_DIR" ]; then
+    mkdir -p "$SOLVER_CACHE_DIR"
+    AIG_CACHE_KEY=$(cat "$CONSTRAINT_JSON" ./build/MySolver "$YOSYS_EXECUTABLE" <(echo "$YOSYS_SCRIPT_CONTENT" | sed "s|$RUN_DIR||g") | sha256sum | cut -d' ' -f1)
+    CACHED_AIG_FILE="$SOLVER_CACHE_DIR/$AIG_CACHE_KEY.aig"
+    if [ -f "$CACHED_AIG_FILE" ] && ./build/MySolver aig-to-bdd "$CACHED_AIG_FILE" "$CONSTRAINT_JSON" "$NUM_SAMPLES" "$FINAL_RESULT_JSON" "$RANDOM_SEED" "${SOLVER_OPTIONS[@]}" --cache-lookup; then
+        exit 0
+    fi
+fi
+
+./build/MySolver json-to-v "$CONSTRAINT_JSON" "$RUN_DIR"
 "$YOSYS_EXECUTABLE" -q -p "$YOSYS_SCRIPT_CONTENT"
-./build/MySolver aig-to-bdd "$OUTPUT_AIG_FILE" "$CONSTRAINT_JSON" "$NUM_SAMPLES" "$FINAL_RESULT_JSON" "$RANDOM_SEED"
+if [ -n "$SOLVER_CACHE_DIR" ]; then
+    cp "$OUTPUT_AIG_FILE" "$CACHED_AIG_FILE.$$" && mv "$CACHED_AIG_FILE.$$" "$CACHED_AIG_FILE"
+fi
+./build/MySolver aig-to-bdd "$OUTPUT_AIG_FILE" "$CONSTRAINT_JSON" "$NUM_SAMPLES" "$FINAL_RESULT_JSON" "$RANDOM_SEED" "${SOLVER_OPTIONS[@]}"
@@ -1,159 +1,328 @@
+#include "mapped_file.h"
+#include "packed_assignment_set.h"
+#include "path_count_engines.h"
+#include "result_writer.h"
 #include "solver_functions.h"
+#include "support_set.h"
+#include "thread_pool.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <map>
-#include <quadmath.h>
-#include <cmath>
-
-namespace std {
-inline __float128 nextafter(__float128 __x, __float128 __y) {
-    return ::nextafterq(__x, __y);
-}
-} // namespace std
-
+#include <memory>
+#include <numeric>
 #include <random>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "cudd.h"
 #include "nlohmann/json.hpp"
+#include <unistd.h>
 
 using json = nlohmann::json;
 using namespace std;
 
 string to_hex_string(unsigned long long value, int bit_width);
 
-static std::vector<int> determine_bdd_variable_order(
-    int nI_total, const std::vector<int> &aig_primary_input_literals,
-    const std::vector<int> &circuit_output_literals_from_aig,
-    const std::map<int, std::pair<int, int>> &and_gate_definitions);
+struct SampleMatrix {
+    int words_per_row = 0;
+    std::vector<uint64_t> words;
+    std::vector<unsigned char> valid;
 
-struct PathCounts {
-    __float128 even_cnt;
-    __float128 odd_cnt;
+    void reset(int num_rows, int num_bits) {
+        words_per_row = (num_bits + 63) / 64;
+        words.assign(static_cast<size_t>(num_rows) * words_per_row, 0);
+        valid.assign(num_rows, 1);
+    }
+
+    uint64_t *row(int row_idx) { return &words[row_idx * words_per_row]; }
+
+    const uint64_t *row(int row_idx) const {
+        return &words[row_idx * words_per_row];
+    }
 };
 
-static std::map<DdNode *, PathCounts> path_counts_memo;
-
-static std::mt19937 rng;
-
-PathCounts compute_path_counts_recursive(DdNode *node_regular,
-                                         DdManager *manager) {
-    if (node_regular == Cudd_ReadOne(manager))
-        return {1.0Q, 0.0Q};
-    if (node_regular == Cudd_ReadLogicZero(manager))
-        return {0.0Q, 0.0Q};
-    auto it = path_counts_memo.find(node_regular);
-    if (it != path_counts_memo.end())
-        return it->second;
-    DdNode *E_child = Cudd_E(node_regular);
-    DdNode *T_child = Cudd_T(node_regular);
-    DdNode *E_child_regular = Cudd_Regular(E_child);
-    DdNode *T_child_regular = Cudd_Regular(T_child);
-    PathCounts counts_E =
-        compute_path_counts_recursive(E_child_regular, manager);
-    PathCounts counts_T =
-        compute_path_counts_recursive(T_child_regular, manager);
-    __float128 current_even_cnt = 0.0Q;
-    __float128 current_odd_cnt = 0.0Q;
-    if (Cudd_IsComplement(E_child)) {
-        current_even_cnt += counts_E.odd_cnt;
-        current_odd_cnt += counts_E.even_cnt;
-    } else {
-        current_even_cnt += counts_E.even_cnt;
-        current_odd_cnt += counts_E.odd_cnt;
+static void set_packed_bit(uint64_t *row, int bit) {
+    row[bit / 64] |= 1ULL << (bit % 64);
+}
+
+static void clear_packed_bit(uint64_t *row, int bit) {
+    row[bit / 64] &= ~(1ULL << (bit % 64));
+}
+
+static bool get_packed_bit(const uint64_t *row, int bit) {
+    return (row[bit / 64] >> (bit % 64)) & 1;
+}
+
+struct FlatBdd {
+    std::vector<int> bit_position;
+    std::vector<int> else_child;
+    std::vector<int> then_child;
+    std::vector<unsigned char> else_complement;
+    std::vector<unsigned char> then_complement;
+    int root = 0;
+    bool root_complement = false;
+};
+
+struct ReorderMonitor {
+    int component_idx = 0;
+    bool log_events = false;
+    long time_budget_ms = 0;
+    long total_reorder_ms = 0;
+    int num_reorders = 0;
+    long nodes_before = 0;
+    std::chrono::high_resolution_clock::time_point start_time;
+};
+
+struct BuiltComponent {
+    DdManager *manager = nullptr;
+    int num_manager_vars = 0;
+    ComponentBdd bdd;
+    FlatBdd flat;
+    ReorderMonitor reorder_monitor;
+    bool built = false;
+};
+
+template <typename Engine> struct ComponentCounts {
+    using Word = typename Engine::Word;
+
+    int words_per_count = 1;
+    std::vector<Word> solution_counts;
+    std::vector<uint64_t> else_thresholds;
+    std::vector<Word> target_solutions;
+
+    Word *count(int node, bool odd_parity) {
+        return &solution_counts[(2 * static_cast<size_t>(node) + odd_parity) *
+                            words_per_count];
     }
-    if (Cudd_IsComplement(T_child)) {
-        current_even_cnt += counts_T.odd_cnt;
-        current_odd_cnt += counts_T.even_cnt;
-    } else {
-        current_even_cnt += counts_T.even_cnt;
-        current_odd_cnt += counts_T.odd_cnt;
+
+    const Word *count(int node, bool odd_parity) const {
+        return &solution_counts[(2 * static_cast<size_t>(node) + odd_parity) *
+                            words_per_count];
     }
-    PathCounts result = {current_even_cnt, current_odd_cnt};
-    path_counts_memo[node_regular] = result;
-    return result;
+};
+
+template <typename Engine> struct ComponentSampler {
+    const BuiltComponent *component;
+    Engine engine;
+    std::shared_ptr<ComponentCounts<Engine>> counts;
+    std::mt19937_64 rng;
+};
+
+static void add_flat_node(FlatBdd &flat, int bit_position, int else_child,
+                          bool else_complement, int then_child,
+                          bool then_complement) {
+    flat.bit_position.push_back(bit_position);
+    flat.else_child.push_back(else_child);
+    flat.then_child.push_back(then_child);
+    flat.else_complement.push_back(else_complement);
+    flat.then_complement.push_back(then_complement);
 }
 
-bool generate_random_solution_dfs(
-    DdNode *current_node_regular, bool accumulated_odd_complements_so_far,
-    DdManager *manager, std::map<int, int> &assignment_map,
-    std::uniform_real_distribution<__float128> &dist) {
-    if (current_node_regular == Cudd_ReadOne(manager))
-        return true;
-    if (current_node_regular == Cudd_ReadLogicZero(manager))
-        return false;
-    DdNode *E_child_ptr = Cudd_E(current_node_regular);
-    DdNode *T_child_ptr = Cudd_T(current_node_regular);
-    DdNode *E_child_regular = Cudd_Regular(E_child_ptr);
-    DdNode *T_child_regular = Cudd_Regular(T_child_ptr);
-    bool is_complement_E = Cudd_IsComplement(E_child_ptr);
-    bool is_complement_T = Cudd_IsComplement(T_child_ptr);
-    PathCounts counts_from_E_child =
-        compute_path_counts_recursive(E_child_regular, manager);
-    PathCounts counts_from_T_child =
-        compute_path_counts_recursive(T_child_regular, manager);
-    bool required_odd_parity_for_E_path =
-        accumulated_odd_complements_so_far ^ is_complement_E;
-    __float128 cnt_paths_via_E;
-    if (required_odd_parity_for_E_path)
-        cnt_paths_via_E = counts_from_E_child.odd_cnt;
-    else
-        cnt_paths_via_E = counts_from_E_child.even_cnt;
-    bool required_odd_parity_for_T_path =
-        accumulated_odd_complements_so_far ^ is_complement_T;
-    __float128 cnt_paths_via_T;
-    if (required_odd_parity_for_T_path)
-        cnt_paths_via_T = counts_from_T_child.odd_cnt;
-    else
-        cnt_paths_via_T = counts_from_T_child.even_cnt;
-    __float128 total_valid_continuing_paths = cnt_paths_via_E + cnt_paths_via_T;
-    int var_index = Cudd_NodeReadIndex(current_node_regular);
-    if (total_valid_continuing_paths <= 0.0Q)
-        return false;
-    __float128 prob_take_E_branch;
-    if (total_valid_continuing_paths > 0.0Q)
-        prob_take_E_branch = cnt_paths_via_E / total_valid_continuing_paths;
-    else
-        prob_take_E_branch = 0.5Q;
-    __float128 random_draw_val = dist(rng);
-    if (random_draw_val < prob_take_E_branch) {
-        assignment_map[var_index] = 0;
-        return generate_random_solution_dfs(E_child_regular,
-                                            required_odd_parity_for_E_path,
-                                            manager, assignment_map, dist);
-    } else {
-        assignment_map[var_index] = 1;
-        return generate_random_solution_dfs(T_child_regular,
-                                            required_odd_parity_for_T_path,
-                                            manager, assignment_map, dist);
+static FlatBdd flatten_component_bdd(DdManager *manager,
+                                     const ComponentBdd &component) {
+    std::vector<int> var_to_bit_position(Cudd_ReadSize(manager), -1);
+    for (size_t k = 0; k < component.input_vars.size(); ++k)
+        var_to_bit_position[Cudd_NodeReadIndex(component.input_vars[k])] = k;
+    FlatBdd flat;
+    std::unordered_map<DdNode *, int> node_indices;
+    node_indices[Cudd_ReadOne(manager)] = 0;
+    add_flat_node(flat, -1, 0, false, 0, false);
+    std::vector<std::pair<DdNode *, bool>> pending_nodes = {
+        {Cudd_Regular(component.output), false}};
+    while (!pending_nodes.empty()) {
+        DdNode *node = pending_nodes.back().first;
+        bool children_indexed = pending_nodes.back().second;
+        if (node_indices.count(node)) {
+            pending_nodes.pop_back();
+            continue;
+        }
+        DdNode *E_child = Cudd_E(node);
+        DdNode *T_child = Cudd_T(node);
+        if (!children_indexed) {
+            pending_nodes.back().second = true;
+            pending_nodes.push_back({Cudd_Regular(T_child), false});
+            pending_nodes.push_back({Cudd_Regular(E_child), false});
+            continue;
+        }
+        pending_nodes.pop_back();
+        int bit_position = var_to_bit_position.at(Cudd_NodeReadIndex(node));
+        if (bit_position < 0)
+            throw std::runtime_error(
+                "BDD node depends on a variable outside its component.");
+        node_indices[node] = flat.bit_position.size();
+        add_flat_node(flat, bit_position,
+                      node_indices.at(Cudd_Regular(E_child)),
+                      Cudd_IsComplement(E_child),
+                      node_indices.at(Cudd_Regular(T_child)),
+                      Cudd_IsComplement(T_child));
+    }
+    flat.root = node_indices.at(Cudd_Regular(component.output));
+    flat.root_complement = Cudd_IsComplement(component.output);
+    return flat;
+}
+
+// Component inputs are kept in level order, so a node's bit position is its
+// level and the terminal sits one level below the last input.
+static int get_node_level(const FlatBdd &flat, int num_levels, int node) {
+    return node ? flat.bit_position[node] : num_levels;
+}
+
+template <typename Engine>
+static void compute_solution_counts(ComponentSampler<Engine> &sampler) {
+    const FlatBdd &flat = sampler.component->flat;
+    const Engine &engine = sampler.engine;
+    ComponentCounts<Engine> &counts = *sampler.counts;
+    size_t num_nodes = flat.bit_position.size();
+    int num_levels = sampler.component->bdd.bit_indices.size();
+    counts.words_per_count = engine.get_words_per_count();
+    counts.solution_counts.resize(2 * num_nodes * counts.words_per_count);
+    engine.set_one(counts.count(0, false));
+    engine.set_zero(counts.count(0, true));
+    counts.else_thresholds.assign(2 * num_nodes, 0);
+    for (size_t i = 1; i < num_nodes; ++i) {
+        int E_gap = get_node_level(flat, num_levels, flat.else_child[i]) -
+                    flat.bit_position[i] - 1;
+        int T_gap = get_node_level(flat, num_levels, flat.then_child[i]) -
+                    flat.bit_position[i] - 1;
+        for (int odd_parity = 0; odd_parity < 2; ++odd_parity) {
+            const typename Engine::Word *E_cnt = counts.count(
+                flat.else_child[i], odd_parity ^ flat.else_complement[i]);
+            const typename Engine::Word *T_cnt = counts.count(
+                flat.then_child[i], odd_parity ^ flat.then_complement[i]);
+            typename Engine::Word *total = counts.count(i, odd_parity);
+            engine.add_scaled(total, E_cnt, E_gap, T_cnt, T_gap);
+            uint64_t &threshold = counts.else_thresholds[2 * i + odd_parity];
+            if (engine.is_zero(E_cnt))
+                threshold = 0;
+            else if (engine.is_zero(T_cnt))
+                threshold = UINT64_MAX;
+            else
+                threshold = engine.else_threshold(E_cnt, E_gap, total);
+        }
     }
+    // The terminal's odd count is always zero.
+    counts.target_solutions.resize(counts.words_per_count);
+    engine.add_scaled(counts.target_solutions.data(),
+                      counts.count(flat.root, flat.root_complement),
+                      get_node_level(flat, num_levels, flat.root),
+                      counts.count(0, true), 0);
 }
 
-struct AigData {
-    int nM, nI, nL, nO, nA;
-    std::vector<int> primary_input_literals;
-    std::map<int, int> literal_to_original_pi_index;
-    std::vector<int> circuit_output_literals;
-    std::map<int, std::pair<int, int>> and_gate_definitions;
-    std::vector<std::tuple<int, int, int>> and_gate_lines_for_processing;
+template <typename Engine>
+static bool generate_random_solution(ComponentSampler<Engine> &sampler,
+                                     int node, bool odd_parity,
+                                     uint64_t *row) {
+    const FlatBdd &flat = sampler.component->flat;
+    while (node != 0) {
+        uint64_t threshold =
+            sampler.counts->else_thresholds[2 * node + odd_parity];
+        if (threshold == UINT64_MAX ||
+            (threshold != 0 && sampler.rng() < threshold)) {
+            clear_packed_bit(row, flat.bit_position[node]);
+            odd_parity ^= flat.else_complement[node];
+            node = flat.else_child[node];
+        } else {
+            set_packed_bit(row, flat.bit_position[node]);
+            odd_parity ^= flat.then_complement[node];
+            node = flat.then_child[node];
+        }
+    }
+    return !odd_parity;
+}
+
+const int MAX_BERNOULLI_SPLIT_SLOTS = 32;
+
+struct PendingBatch {
+    int node;
+    bool odd_parity;
+    int first_slot;
+    int num_slots;
 };
 
-static DdManager *initialize_cudd_manager() {
+template <typename Engine>
+static void generate_random_solution_batch(ComponentSampler<Engine> &sampler,
+                                           SampleMatrix &draws,
+                                           int num_draws) {
+    const FlatBdd &flat = sampler.component->flat;
+    std::vector<int> slot_rows(num_draws);
+    std::iota(slot_rows.begin(), slot_rows.end(), 0);
+    std::shuffle(slot_rows.begin(), slot_rows.end(), sampler.rng);
+    std::vector<PendingBatch> pending_batches = {
+        {flat.root, flat.root_complement, 0, num_draws}};
+    while (!pending_batches.empty()) {
+        PendingBatch batch = pending_batches.back();
+        pending_batches.pop_back();
+        if (batch.num_slots == 1) {
+            int row_idx = slot_rows[batch.first_slot];
+            draws.valid[row_idx] = generate_random_solution(
+                sampler, batch.node, batch.odd_parity, draws.row(row_idx));
+            continue;
+        }
+        if (batch.node == 0) {
+            if (batch.odd_parity)
+                for (int slot = batch.first_slot;
+                     slot < batch.first_slot + batch.num_slots; ++slot)
+                    draws.valid[slot_rows[slot]] = 0;
+            continue;
+        }
+        uint64_t threshold =
+            sampler.counts->else_thresholds[2 * batch.node + batch.odd_parity];
+        int num_else = 0;
+        if (threshold == 0 || threshold == UINT64_MAX)
+            num_else = threshold ? batch.num_slots : 0;
+        else if (batch.num_slots <= MAX_BERNOULLI_SPLIT_SLOTS)
+            for (int slot = 0; slot < batch.num_slots; ++slot)
+                num_else += sampler.rng() < threshold;
+        else {
+            std::binomial_distribution<int> split(
+                batch.num_slots,
+                std::ldexp(static_cast<double>(threshold), -64));
+            num_else = split(sampler.rng);
+        }
+        int bit_position = flat.bit_position[batch.node];
+        for (int slot = batch.first_slot; slot < batch.first_slot + num_else;
+             ++slot)
+            clear_packed_bit(draws.row(slot_rows[slot]), bit_position);
+        for (int slot = batch.first_slot + num_else;
+             slot < batch.first_slot + batch.num_slots; ++slot)
+            set_packed_bit(draws.row(slot_rows[slot]), bit_position);
+        if (num_else < batch.num_slots)
+            pending_batches.push_back(
+                {flat.then_child[batch.node],
+                 static_cast<bool>(batch.odd_parity ^
+                                   flat.then_complement[batch.node]),
+                 batch.first_slot + num_else, batch.num_slots - num_else});
+        if (num_else > 0)
+            pending_batches.push_back(
+                {flat.else_child[batch.node],
+                 static_cast<bool>(batch.odd_parity ^
+                                   flat.else_complement[batch.node]),
+                 batch.first_slot, num_else});
+    }
+}
+
+DdManager *initialize_cudd_manager() {
     auto cudd_init_start_time = std::chrono::high_resolution_clock::now();
     DdManager *manager =
         Cudd_Init(0, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0);
     if (!manager)
         return nullptr;
-    Cudd_AutodynEnable(manager, CUDD_REORDER_SIFT);
     auto cudd_init_end_time = std::chrono::high_resolution_clock::now();
     auto cudd_init_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -161,17 +330,134 @@ static DdManager *initialize_cudd_manager() {
     return manager;
 }
 
-static bool parse_aig_header(std::ifstream &aig_file_stream, AigData &data) {
+static Cudd_ReorderingType get_reordering_method(const std::string &name,
+                                                 bool converge) {
+    if (name == "sift")
+        return converge ? CUDD_REORDER_SIFT_CONVERGE : CUDD_REORDER_SIFT;
+    if (name == "symmetric")
+        return converge ? CUDD_REORDER_SYMM_SIFT_CONV : CUDD_REORDER_SYMM_SIFT;
+    if (name == "group")
+        return converge ? CUDD_REORDER_GROUP_SIFT_CONV
+                        : CUDD_REORDER_GROUP_SIFT;
+    if (name == "window")
+        return converge ? CUDD_REORDER_WINDOW4_CONV : CUDD_REORDER_WINDOW4;
+    if (name == "annealing")
+        return CUDD_REORDER_ANNEALING;
+    return CUDD_REORDER_NONE;
+}
+
+static int record_reorder_start(DdManager *manager, const char *, void *) {
+    auto *monitor =
+        static_cast<ReorderMonitor *>(Cudd_ReadApplicationHook(manager));
+    monitor->nodes_before = Cudd_ReadNodeCount(manager);
+    monitor->start_time = std::chrono::high_resolution_clock::now();
+    return 1;
+}
+
+static int record_reorder_end(DdManager *manager, const char *, void *) {
+    auto *monitor =
+        static_cast<ReorderMonitor *>(Cudd_ReadApplicationHook(manager));
+    long reorder_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::high_resolution_clock::now() -
+                          monitor->start_time)
+                          .count();
+    monitor->total_reorder_ms += reorder_ms;
+    ++monitor->num_reorders;
+    if (monitor->log_events)
+        fprintf(stderr, "component %d reorder %d: %ld -> %ld nodes, %ld ms\n",
+                monitor->component_idx, monitor->num_reorders,
+                monitor->nodes_before, Cudd_ReadNodeCount(manager),
+                reorder_ms);
+    if (monitor->time_budget_ms > 0 &&
+        monitor->total_reorder_ms >= monitor->time_budget_ms)
+        Cudd_AutodynDisable(manager);
+    return 1;
+}
+
+static bool configure_reordering(DdManager *manager,
+                                 const SolverOptions &options,
+                                 ReorderMonitor &monitor) {
+    monitor.log_events = options.log_reorder_events;
+    monitor.time_budget_ms = options.reorder_time_budget_ms;
+    Cudd_SetApplicationHook(manager, &monitor);
+    if (!Cudd_AddHook(manager, record_reorder_start,
+                      CUDD_PRE_REORDERING_HOOK) ||
+        !Cudd_AddHook(manager, record_reorder_end, CUDD_POST_REORDERING_HOOK))
+        return false;
+    Cudd_ReorderingType method =
+        get_reordering_method(options.reorder_method, false);
+    if (method == CUDD_REORDER_NONE)
+        return true;
+    Cudd_SetMaxGrowth(manager, options.reorder_max_growth);
+    Cudd_SetNextReordering(manager, options.reorder_first_threshold);
+    if (options.reorder_max_count > 0)
+        Cudd_SetMaxReorderings(manager, options.reorder_max_count);
+    Cudd_AutodynEnable(manager, method);
+    return true;
+}
+
+static bool converge_final_order(DdManager *manager,
+                                 const SolverOptions &options) {
+    Cudd_AutodynDisable(manager);
+    Cudd_ReorderingType method =
+        get_reordering_method(options.reorder_method, true);
+    if (!options.final_reorder || method == CUDD_REORDER_NONE)
+        return true;
+    return Cudd_ReduceHeap(manager, method, 0) != 0;
+}
+
+static bool read_unsigned(const char *&pos, const char *end, int &value) {
+    while (pos < end && (*pos == ' ' || *pos == '\t'))
+        ++pos;
+    if (pos == end || *pos < '0' || *pos > '9')
+        return false;
+    int64_t parsed_value = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        parsed_value = parsed_value * 10 + (*pos++ - '0');
+        if (parsed_value > INT32_MAX)
+            return false;
+    }
+    value = static_cast<int>(parsed_value);
+    return true;
+}
+
+static void skip_line(const char *&pos, const char *end) {
+    const char *newline =
+        static_cast<const char *>(memchr(pos, '\n', end - pos));
+    pos = newline ? newline + 1 : end;
+}
+
+static bool read_binary_delta(const char *&pos, const char *end, int &delta) {
+    uint32_t value = 0;
+    for (int shift = 0; pos < end && shift < 32; shift += 7) {
+        unsigned char byte = *pos++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            delta = static_cast<int>(value);
+            return delta >= 0;
+        }
+    }
+    return false;
+}
+
+static bool parse_aig_header(const char *&pos, const char *end, AigData &data,
+                             bool &is_binary) {
     auto aig_header_parse_start_time =
         std::chrono::high_resolution_clock::now();
-    std::string line;
-    if (!getline(aig_file_stream, line) || line.substr(0, 3) != "aag")
+    if (end - pos < 4 || (memcmp(pos, "aag ", 4) && memcmp(pos, "aig ", 4)))
         return false;
-    stringstream header_ss(line.substr(4));
-    if (!(header_ss >> data.nM >> data.nI >> data.nL >> data.nO >> data.nA))
+    is_binary = pos[1] == 'i';
+    pos += 4;
+    if (!read_unsigned(pos, end, data.nM) ||
+        !read_unsigned(pos, end, data.nI) ||
+        !read_unsigned(pos, end, data.nL) ||
+        !read_unsigned(pos, end, data.nO) || !read_unsigned(pos, end, data.nA))
         return false;
+    skip_line(pos, end);
     if (data.nO == 0)
         return false;
+    if (is_binary && data.nM != data.nI + data.nL + data.nA)
+        return false;
     auto aig_header_parse_end_time = std::chrono::high_resolution_clock::now();
     auto aig_header_parse_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -179,41 +465,63 @@ static bool parse_aig_header(std::ifstream &aig_file_stream, AigData &data) {
     return true;
 }
 
-static bool read_aig_structure(std::ifstream &aig_file_stream, AigData &data) {
+static bool read_aig_structure(const char *&pos, const char *end,
+                               bool is_binary, AigData &data) {
     auto aig_preread_start_time = std::chrono::high_resolution_clock::now();
+    int max_literal = 2 * data.nM + 1;
     data.primary_input_literals.resize(data.nI);
-    std::string line;
+    data.input_index_by_var.assign(data.nM + 1, -1);
+    data.is_and_var.assign(data.nM + 1, 0);
+    data.and_fanins.assign(2 * (data.nM + 1), 0);
+    data.and_gate_vars.clear();
     for (int i = 0; i < data.nI; ++i) {
-        if (!getline(aig_file_stream, line))
-            return false;
-        int input_lit;
-        if (sscanf(line.c_str(), "%d", &input_lit) != 1)
+        int input_lit = 2 * (i + 1);
+        if (!is_binary) {
+            if (!read_unsigned(pos, end, input_lit))
+                return false;
+            skip_line(pos, end);
+        }
+        if (input_lit < 2 || input_lit > max_literal || (input_lit & 1))
             return false;
         data.primary_input_literals[i] = input_lit;
-        data.literal_to_original_pi_index[input_lit] = i;
+        data.input_index_by_var[input_lit / 2] = i;
     }
     for (int i = 0; i < data.nL; ++i)
-        if (!getline(aig_file_stream, line))
-            return false;
+        skip_line(pos, end);
     data.circuit_output_literals.resize(data.nO);
     for (int i = 0; i < data.nO; ++i) {
-        if (!getline(aig_file_stream, line))
-            return false;
         int output_lit;
-        if (sscanf(line.c_str(), "%d", &output_lit) != 1)
+        if (!read_unsigned(pos, end, output_lit) || output_lit > max_literal)
             return false;
+        skip_line(pos, end);
         data.circuit_output_literals[i] = output_lit;
     }
     for (int i = 0; i < data.nA; ++i) {
-        if (!getline(aig_file_stream, line))
-            return false;
-        stringstream ss(line);
         int output_lit, input1_lit, input2_lit;
-        if (!(ss >> output_lit >> input1_lit >> input2_lit))
+        if (is_binary) {
+            int delta1, delta2;
+            output_lit = 2 * (data.nI + data.nL + i + 1);
+            if (!read_binary_delta(pos, end, delta1) ||
+                !read_binary_delta(pos, end, delta2))
+                return false;
+            input1_lit = output_lit - delta1;
+            input2_lit = input1_lit - delta2;
+        } else {
+            if (!read_unsigned(pos, end, output_lit) ||
+                !read_unsigned(pos, end, input1_lit) ||
+                !read_unsigned(pos, end, input2_lit))
+                return false;
+            skip_line(pos, end);
+        }
+        if (output_lit < 2 || output_lit > max_literal || (output_lit & 1) ||
+            input1_lit < 0 || input1_lit > max_literal || input2_lit < 0 ||
+            input2_lit > max_literal)
             return false;
-        data.and_gate_definitions[output_lit] = {input1_lit, input2_lit};
-        data.and_gate_lines_for_processing.emplace_back(output_lit, input1_lit,
-                                                        input2_lit);
+        int output_var = output_lit / 2;
+        data.is_and_var[output_var] = 1;
+        data.and_fanins[2 * output_var] = input1_lit;
+        data.and_fanins[2 * output_var + 1] = input2_lit;
+        data.and_gate_vars.push_back(output_var);
     }
     auto aig_preread_end_time = std::chrono::high_resolution_clock::now();
     auto aig_preread_duration =
@@ -224,53 +532,22 @@ static bool read_aig_structure(std::ifstream &aig_file_stream, AigData &data) {
 
 static bool
 create_bdd_variables(DdManager *manager, const AigData &data,
-                     std::map<int, DdNode *> &literal_to_bdd_map,
-                     std::vector<DdNode *> &input_vars_bdd,
-                     std::map<int, int> &cudd_idx_to_original_aig_pi_file_idx) {
-    auto var_order_start_time = std::chrono::high_resolution_clock::now();
-    input_vars_bdd.resize(data.nI);
-    std::vector<int> ordered_aig_pi_literals_for_bdd_creation =
-        determine_bdd_variable_order(data.nI, data.primary_input_literals,
-                                     data.circuit_output_literals,
-                                     data.and_gate_definitions);
-    auto var_order_end_time = std::chrono::high_resolution_clock::now();
-    auto var_order_duration =
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            var_order_end_time - var_order_start_time);
+                     const std::vector<int> &ordered_pi_literals,
+                     std::vector<DdNode *> &literal_to_bdd_map,
+                     ComponentBdd &component) {
     auto bdd_var_creation_start_time =
         std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < data.nI; ++i) {
-        int current_aig_pi_literal_to_create;
-        if (i < ordered_aig_pi_literals_for_bdd_creation.size())
-            current_aig_pi_literal_to_create =
-                ordered_aig_pi_literals_for_bdd_creation[i];
-        else {
-            bool found_uncreated = false;
-            for (int orig_pi_lit : data.primary_input_literals)
-                if (literal_to_bdd_map.find(orig_pi_lit) ==
-                    literal_to_bdd_map.end()) {
-                    current_aig_pi_literal_to_create = orig_pi_lit;
-                    found_uncreated = true;
-                    break;
-                }
-            if (!found_uncreated)
-                return false;
-        }
+    for (int pi_literal : ordered_pi_literals) {
         DdNode *var_node = Cudd_bddNewVar(manager);
         if (!var_node)
             return false;
-        literal_to_bdd_map[current_aig_pi_literal_to_create] = var_node;
-        literal_to_bdd_map[current_aig_pi_literal_to_create + 1] =
-            Cudd_Not(var_node);
+        literal_to_bdd_map[pi_literal] = var_node;
+        literal_to_bdd_map[pi_literal + 1] = Cudd_Not(var_node);
         Cudd_Ref(var_node);
         Cudd_Ref(Cudd_Not(var_node));
-        int original_pi_idx = data.literal_to_original_pi_index.at(
-            current_aig_pi_literal_to_create);
-        input_vars_bdd[original_pi_idx] = var_node;
-        int cudd_var_idx = Cudd_NodeReadIndex(var_node);
-        if (Cudd_bddIsVar(manager, var_node))
-            cudd_idx_to_original_aig_pi_file_idx[cudd_var_idx] =
-                original_pi_idx;
+        component.bit_indices.push_back(
+            data.input_index_by_var[pi_literal / 2]);
+        component.input_vars.push_back(var_node);
     }
     auto bdd_var_creation_end_time = std::chrono::high_resolution_clock::now();
     auto bdd_var_creation_duration =
@@ -279,26 +556,69 @@ create_bdd_variables(DdManager *manager, const AigData &data,
     return true;
 }
 
+static void release_var_bdds(DdManager *manager,
+                             std::vector<DdNode *> &literal_to_bdd_map,
+                             int var) {
+    for (int lit = 2 * var; lit <= 2 * var + 1; ++lit)
+        if (literal_to_bdd_map[lit]) {
+            Cudd_RecursiveDeref(manager, literal_to_bdd_map[lit]);
+            literal_to_bdd_map[lit] = nullptr;
+        }
+}
+
 static bool
 build_bdd_for_and_gates(DdManager *manager, const AigData &data,
-                        std::map<int, DdNode *> &literal_to_bdd_map) {
+                        const std::vector<bool> &in_cone,
+                        const std::vector<int> &output_literals,
+                        std::vector<DdNode *> &literal_to_bdd_map,
+                        bool &infeasible) {
     auto and_gate_processing_start_time =
         std::chrono::high_resolution_clock::now();
-    for (const auto &gate_def : data.and_gate_lines_for_processing) {
-        int output_lit = std::get<0>(gate_def);
-        int input1_lit = std::get<1>(gate_def);
-        int input2_lit = std::get<2>(gate_def);
-        auto it1 = literal_to_bdd_map.find(input1_lit);
-        auto it2 = literal_to_bdd_map.find(input2_lit);
-        if (it1 == literal_to_bdd_map.end() || it2 == literal_to_bdd_map.end())
+    literal_to_bdd_map[0] = Cudd_ReadLogicZero(manager);
+    literal_to_bdd_map[1] = Cudd_ReadOne(manager);
+    Cudd_Ref(literal_to_bdd_map[0]);
+    Cudd_Ref(literal_to_bdd_map[1]);
+    std::vector<int> remaining_uses(data.nM + 1, 0);
+    std::vector<unsigned char> output_polarities(data.nM + 1, 0);
+    for (int output_var : data.and_gate_vars)
+        if (in_cone[output_var]) {
+            ++remaining_uses[data.and_fanins[2 * output_var] / 2];
+            ++remaining_uses[data.and_fanins[2 * output_var + 1] / 2];
+        }
+    for (int output_lit : output_literals) {
+        ++remaining_uses[output_lit / 2];
+        output_polarities[output_lit / 2] |= 1 << (output_lit & 1);
+        if (output_lit == 0)
+            infeasible = true;
+    }
+    for (int output_var : data.and_gate_vars) {
+        if (infeasible)
+            break;
+        if (!in_cone[output_var])
+            continue;
+        int output_lit = 2 * output_var;
+        DdNode *input1_bdd = literal_to_bdd_map[data.and_fanins[output_lit]];
+        DdNode *input2_bdd =
+            literal_to_bdd_map[data.and_fanins[output_lit + 1]];
+        if (!input1_bdd || !input2_bdd)
             return false;
-        DdNode *input1_bdd = it1->second;
-        DdNode *input2_bdd = it2->second;
         DdNode *and_node = Cudd_bddAnd(manager, input1_bdd, input2_bdd);
+        if (!and_node)
+            return false;
         Cudd_Ref(and_node);
         literal_to_bdd_map[output_lit] = and_node;
         literal_to_bdd_map[output_lit + 1] = Cudd_Not(and_node);
         Cudd_Ref(Cudd_Not(and_node));
+        for (int k = 0; k < 2; ++k) {
+            int fanin_var = data.and_fanins[output_lit + k] / 2;
+            if (--remaining_uses[fanin_var] == 0 && data.is_and_var[fanin_var])
+                release_var_bdds(manager, literal_to_bdd_map, fanin_var);
+        }
+        if (((output_polarities[output_var] & 1) &&
+             and_node == Cudd_ReadLogicZero(manager)) ||
+            ((output_polarities[output_var] & 2) &&
+             and_node == Cudd_ReadOne(manager)))
+            infeasible = true;
     }
     auto and_gate_processing_end_time =
         std::chrono::high_resolution_clock::now();
@@ -308,158 +628,589 @@ build_bdd_for_and_gates(DdManager *manager, const AigData &data,
     return true;
 }
 
+static std::vector<SupportSet> compute_var_supports(const AigData &data) {
+    auto support_start_time = std::chrono::high_resolution_clock::now();
+    std::vector<SupportSet> var_supports(data.nM + 1);
+    int num_words = (data.nI + 63) / 64;
+    for (int i = 0; i < data.nI; ++i)
+        var_supports[data.primary_input_literals[i] / 2].assign_input(i);
+    for (int output_var : data.and_gate_vars)
+        var_supports[output_var].assign_union(
+            var_supports[data.and_fanins[2 * output_var] / 2],
+            var_supports[data.and_fanins[2 * output_var + 1] / 2], num_words);
+    auto support_end_time = std::chrono::high_resolution_clock::now();
+    auto support_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            support_end_time - support_start_time);
+    return var_supports;
+}
+
+static std::vector<std::vector<int>>
+get_output_components(const AigData &data,
+                      const std::vector<SupportSet> &var_supports) {
+    std::vector<std::set<int>> output_pi_supports;
+    for (int output_lit : data.circuit_output_literals) {
+        std::set<int> output_support;
+        var_supports[output_lit / 2].for_each(
+            [&](int input_idx) { output_support.insert(input_idx); });
+        output_pi_supports.push_back(std::move(output_support));
+    }
+    std::vector<std::vector<int>> component_output_literals;
+    for (const auto &component :
+         get_constraint_components_by_dsu_strategy(output_pi_supports)) {
+        std::vector<int> output_literals;
+        for (int output_idx : component)
+            output_literals.push_back(data.circuit_output_literals[output_idx]);
+        component_output_literals.push_back(output_literals);
+    }
+    return component_output_literals;
+}
+
+static std::vector<bool>
+get_cone_of_influence(const AigData &data,
+                      const std::vector<int> &output_literals) {
+    std::vector<bool> in_cone(data.nM + 1, false);
+    std::vector<int> pending_vars;
+    for (int output_lit : output_literals)
+        pending_vars.push_back(output_lit / 2);
+    while (!pending_vars.empty()) {
+        int var = pending_vars.back();
+        pending_vars.pop_back();
+        if (var <= 0 || var >= static_cast<int>(in_cone.size()) ||
+            in_cone[var])
+            continue;
+        in_cone[var] = true;
+        if (data.is_and_var[var]) {
+            pending_vars.push_back(data.and_fanins[2 * var] / 2);
+            pending_vars.push_back(data.and_fanins[2 * var + 1] / 2);
+        }
+    }
+    return in_cone;
+}
+
+struct ScheduledBdd {
+    int size;
+    int sequence;
+    DdNode *node;
+};
+
+static bool later_scheduled_bdd(const ScheduledBdd &lhs,
+                                const ScheduledBdd &rhs) {
+    if (lhs.size != rhs.size)
+        return lhs.size > rhs.size;
+    return lhs.sequence > rhs.sequence;
+}
+
+static std::vector<int> get_support_indices(DdManager *manager,
+                                            DdNode *node) {
+    int *indices = nullptr;
+    int support_size = Cudd_SupportIndices(manager, node, &indices);
+    std::vector<int> support;
+    if (support_size > 0)
+        support.assign(indices, indices + support_size);
+    free(indices);
+    return support;
+}
+
+static void release_scheduled_bdds(DdManager *manager,
+                                   std::vector<ScheduledBdd> &pending) {
+    for (const auto &scheduled : pending)
+        Cudd_RecursiveDeref(manager, scheduled.node);
+    pending.clear();
+}
+
+static DdNode *conjoin_smallest_first(DdManager *manager,
+                                      std::vector<ScheduledBdd> &pending) {
+    int next_sequence = pending.size();
+    std::make_heap(pending.begin(), pending.end(), later_scheduled_bdd);
+    while (pending.size() > 1) {
+        std::pop_heap(pending.begin(), pending.end(), later_scheduled_bdd);
+        ScheduledBdd lhs = pending.back();
+        pending.pop_back();
+        std::pop_heap(pending.begin(), pending.end(), later_scheduled_bdd);
+        ScheduledBdd rhs = pending.back();
+        pending.pop_back();
+        DdNode *product = Cudd_bddAnd(manager, lhs.node, rhs.node);
+        if (product)
+            Cudd_Ref(product);
+        Cudd_RecursiveDeref(manager, lhs.node);
+        Cudd_RecursiveDeref(manager, rhs.node);
+        if (!product || product == Cudd_ReadLogicZero(manager)) {
+            release_scheduled_bdds(manager, pending);
+            return product;
+        }
+        pending.push_back({Cudd_DagSize(product), next_sequence++, product});
+        std::push_heap(pending.begin(), pending.end(), later_scheduled_bdd);
+    }
+    return pending.back().node;
+}
+
+static DdNode *conjoin_by_shared_support(DdManager *manager,
+                                         std::vector<ScheduledBdd> &pending) {
+    std::vector<std::vector<int>> supports;
+    for (const auto &scheduled : pending)
+        supports.push_back(get_support_indices(manager, scheduled.node));
+    size_t first = std::min_element(pending.begin(), pending.end(),
+                                    [](const ScheduledBdd &lhs,
+                                       const ScheduledBdd &rhs) {
+                                        return later_scheduled_bdd(rhs, lhs);
+                                    }) -
+                   pending.begin();
+    DdNode *product = pending[first].node;
+    std::vector<bool> in_product(Cudd_ReadSize(manager), false);
+    for (int index : supports[first])
+        in_product[index] = true;
+    std::vector<bool> conjoined(pending.size(), false);
+    conjoined[first] = true;
+    for (size_t step = 1; step < pending.size(); ++step) {
+        size_t best = pending.size();
+        int best_overlap = -1;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (conjoined[i])
+                continue;
+            int overlap = 0;
+            for (int index : supports[i])
+                overlap += in_product[index];
+            if (overlap > best_overlap ||
+                (overlap == best_overlap &&
+                 later_scheduled_bdd(pending[best], pending[i]))) {
+                best = i;
+                best_overlap = overlap;
+            }
+        }
+        conjoined[best] = true;
+        for (int index : supports[best])
+            in_product[index] = true;
+        DdNode *next_product =
+            Cudd_bddAnd(manager, product, pending[best].node);
+        if (next_product)
+            Cudd_Ref(next_product);
+        Cudd_RecursiveDeref(manager, product);
+        Cudd_RecursiveDeref(manager, pending[best].node);
+        product = next_product;
+        if (!product || product == Cudd_ReadLogicZero(manager)) {
+            for (size_t i = 0; i < pending.size(); ++i)
+                if (!conjoined[i])
+                    Cudd_RecursiveDeref(manager, pending[i].node);
+            break;
+        }
+    }
+    pending.clear();
+    return product;
+}
+
 static DdNode *
-get_final_bdd_output(DdManager *manager, const AigData &data,
-                     const std::map<int, DdNode *> &literal_to_bdd_map) {
+get_component_bdd_output(DdManager *manager,
+                         const std::vector<int> &output_literals,
+                         const std::vector<DdNode *> &literal_to_bdd_map,
+                         const std::string &conjoin_schedule) {
     auto get_output_bdd_start_time = std::chrono::high_resolution_clock::now();
-    DdNode *bdd_circuit_output = nullptr;
-    if (data.nO > 0) {
-        int first_output_lit = data.circuit_output_literals[0];
-        auto it = literal_to_bdd_map.find(first_output_lit);
-        if (it == literal_to_bdd_map.end())
+    std::vector<ScheduledBdd> pending;
+    for (int output_lit : output_literals) {
+        DdNode *output_bdd = literal_to_bdd_map[output_lit];
+        if (!output_bdd) {
+            release_scheduled_bdds(manager, pending);
             return nullptr;
-        bdd_circuit_output = it->second;
-        Cudd_Ref(bdd_circuit_output);
-    } else
-        return nullptr;
+        }
+        Cudd_Ref(output_bdd);
+        pending.push_back({Cudd_DagSize(output_bdd),
+                           static_cast<int>(pending.size()), output_bdd});
+    }
+    if (pending.empty()) {
+        Cudd_Ref(Cudd_ReadOne(manager));
+        return Cudd_ReadOne(manager);
+    }
+    DdNode *component_output = conjoin_schedule == "support"
+                                   ? conjoin_by_shared_support(manager, pending)
+                                   : conjoin_smallest_first(manager, pending);
     auto get_output_bdd_end_time = std::chrono::high_resolution_clock::now();
     auto get_output_bdd_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             get_output_bdd_end_time - get_output_bdd_start_time);
-    return bdd_circuit_output;
+    return component_output;
 }
 
-static json perform_bdd_sampling(
-    DdManager *manager, DdNode *bdd_circuit_output, int num_samples, int nI,
-    const json &original_variable_list,
-    const std::vector<DdNode *> &input_vars_bdd,
-    const std::map<int, int> &cudd_idx_to_original_aig_pi_file_idx
-    [[maybe_unused]]) {
-    auto sampling_logic_start_time = std::chrono::high_resolution_clock::now();
-    json assignment_list = json::array();
-    if (!bdd_circuit_output)
-        return assignment_list;
-    path_counts_memo.clear();
-    DdNode *regular_root_bdd = Cudd_Regular(bdd_circuit_output);
-    auto dp_start_time = std::chrono::high_resolution_clock::now();
-    PathCounts root_counts =
-        compute_path_counts_recursive(regular_root_bdd, manager);
-    auto dp_end_time = std::chrono::high_resolution_clock::now();
-    auto dp_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        dp_end_time - dp_start_time);
-    __float128 total_target_paths;
-    bool initial_accumulated_odd_complements =
-        Cudd_IsComplement(bdd_circuit_output);
-    if (initial_accumulated_odd_complements)
-        total_target_paths = root_counts.odd_cnt;
+template <typename Engine>
+static void draw_component_samples(ComponentSampler<Engine> &sampler,
+                                   int num_draws, bool batch_sampling,
+                                   SampleMatrix &draws) {
+    draws.reset(num_draws, sampler.component->bdd.bit_indices.size());
+    // Levels a path skips are unconstrained: every bit starts random and the
+    // walk overwrites only the levels it visits.
+    for (uint64_t &word : draws.words)
+        word = sampler.rng();
+    if (batch_sampling)
+        generate_random_solution_batch(sampler, draws, num_draws);
     else
-        total_target_paths = root_counts.even_cnt;
-    char buf[128];
-    quadmath_snprintf(buf, sizeof(buf), "%.0Qf", total_target_paths);
-    if (total_target_paths > 0.0Q) {
-        std::uniform_real_distribution<__float128> dist_float128(0.0Q, 1.0Q);
-        int samples_successfully_generated = 0;
-        int total_dfs_attempts = 0;
-        const int MAX_TOTAL_DFS_ATTEMPTS = num_samples * 200;
-        std::set<std::string> unique_assignment_signatures;
-        while (samples_successfully_generated < num_samples &&
-               total_dfs_attempts < MAX_TOTAL_DFS_ATTEMPTS) {
+        for (int draw_idx = 0; draw_idx < num_draws; ++draw_idx)
+            draws.valid[draw_idx] = generate_random_solution(
+                sampler, sampler.component->flat.root,
+                sampler.component->flat.root_complement, draws.row(draw_idx));
+}
+
+template <typename Engine>
+static void
+count_component_solutions(std::vector<ComponentSampler<Engine>> &samplers,
+                      const std::vector<BuiltComponent> &components,
+                      ThreadPool &pool) {
+    samplers.clear();
+    for (const auto &component : components)
+        samplers.push_back({&component,
+                            Engine(component.num_manager_vars),
+                            std::make_shared<ComponentCounts<Engine>>(),
+                            {}});
+    pool.run_all(samplers.size(), [&](int component_idx) {
+        compute_solution_counts(samplers[component_idx]);
+    });
+}
+
+template <typename Engine>
+static void
+seed_component_samplers(std::vector<ComponentSampler<Engine>> &samplers,
+                        unsigned int random_seed) {
+    for (size_t c = 0; c < samplers.size(); ++c) {
+        std::seed_seq component_seed{random_seed, static_cast<unsigned>(c)};
+        samplers[c].rng.seed(component_seed);
+    }
+}
+
+template <typename Engine>
+static bool
+compose_assignment(const std::vector<ComponentSampler<Engine>> &samplers,
+                   const std::vector<SampleMatrix> &draws, int draw_idx,
+                   int nI, std::vector<uint64_t> &assignment_words) {
+    assignment_words.assign((nI + 63) / 64, 0);
+    for (size_t c = 0; c < samplers.size(); ++c) {
+        const ComponentBdd &component = samplers[c].component->bdd;
+        if (!draws[c].valid[draw_idx])
+            return false;
+        const uint64_t *draw = draws[c].row(draw_idx);
+        for (size_t k = 0; k < component.bit_indices.size(); ++k) {
+            if (component.bit_indices[k] >= nI)
+                throw std::runtime_error(
+                    "JSON variable structure inconsistent with AIG "
+                    "nI during sampling.");
+            if (get_packed_bit(draw, k))
+                set_packed_bit(assignment_words.data(),
+                               component.bit_indices[k]);
+        }
+    }
+    return true;
+}
+
+const uint64_t MAX_UNRANKED_TOTAL_SOLUTIONS = 1ULL << 62;
+
+static void fill_free_bits(const std::vector<int> &free_bits,
+                           std::mt19937_64 &rng, uint64_t *assignment_words) {
+    uint64_t random_bits = 0;
+    for (size_t i = 0; i < free_bits.size(); ++i) {
+        if (i % 64 == 0)
+            random_bits = rng();
+        if ((random_bits >> (i % 64)) & 1)
+            set_packed_bit(assignment_words, free_bits[i]);
+    }
+}
+
+template <typename Engine>
+static bool get_unrankable_total_solutions(
+    const std::vector<ComponentSampler<Engine>> &samplers,
+    const std::vector<int> &free_bits, uint64_t &total_solutions) {
+    if (free_bits.size() >= 62)
+        return false;
+    total_solutions = 1ULL << free_bits.size();
+    for (const auto &sampler : samplers) {
+        uint64_t component_solutions = 0;
+        if (!sampler.engine.to_uint64(sampler.counts->target_solutions.data(),
+                                      component_solutions) ||
+            component_solutions == 0 ||
+            component_solutions >
+                MAX_UNRANKED_TOTAL_SOLUTIONS / total_solutions)
+            return false;
+        total_solutions *= component_solutions;
+    }
+    return true;
+}
+
+static std::vector<uint64_t> draw_distinct_ranks(uint64_t total_solutions,
+                                                 int num_samples,
+                                                 std::mt19937_64 &rng) {
+    std::vector<uint64_t> ranks;
+    if (total_solutions <= static_cast<uint64_t>(num_samples)) {
+        ranks.resize(total_solutions);
+        std::iota(ranks.begin(), ranks.end(), 0);
+        return ranks;
+    }
+    std::unordered_set<uint64_t> chosen_ranks;
+    for (uint64_t j = total_solutions - num_samples; j < total_solutions; ++j) {
+        uint64_t rank = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+        if (!chosen_ranks.insert(rank).second) {
+            chosen_ranks.insert(j);
+            rank = j;
+        }
+        ranks.push_back(rank);
+    }
+    std::shuffle(ranks.begin(), ranks.end(), rng);
+    return ranks;
+}
+
+template <typename Engine>
+static void unrank_component_solution(const ComponentSampler<Engine> &sampler,
+                                      uint64_t rank, int nI,
+                                      uint64_t *assignment_words) {
+    const FlatBdd &flat = sampler.component->flat;
+    const ComponentBdd &component = sampler.component->bdd;
+    int num_levels = component.bit_indices.size();
+    auto get_count = [&](int node, bool odd_parity) {
+        uint64_t count = 0;
+        sampler.engine.to_uint64(sampler.counts->count(node, odd_parity),
+                                 count);
+        return count;
+    };
+    auto set_level_bit = [&](int level) {
+        int bit_idx = component.bit_indices[level];
+        if (bit_idx >= nI)
+            throw std::runtime_error(
+                "JSON variable structure inconsistent with AIG nI during "
+                "sampling.");
+        set_packed_bit(assignment_words, bit_idx);
+    };
+    // Skipped levels take the rank digits above the child's own count.
+    auto unrank_skipped_levels = [&](int first_level, int end_level,
+                                     uint64_t child_count) {
+        uint64_t skipped_bits = rank / child_count;
+        rank %= child_count;
+        for (int level = first_level; level < end_level; ++level)
+            if ((skipped_bits >> (level - first_level)) & 1)
+                set_level_bit(level);
+    };
+    int node = flat.root;
+    bool odd_parity = flat.root_complement;
+    unrank_skipped_levels(0, get_node_level(flat, num_levels, node),
+                          get_count(node, odd_parity));
+    while (node != 0) {
+        int level = flat.bit_position[node];
+        int E_child = flat.else_child[node];
+        bool odd_parity_via_E = odd_parity ^ flat.else_complement[node];
+        uint64_t cnt_via_E = get_count(E_child, odd_parity_via_E);
+        int E_level = get_node_level(flat, num_levels, E_child);
+        uint64_t cnt_solutions_via_E = cnt_via_E << (E_level - level - 1);
+        if (rank < cnt_solutions_via_E) {
+            unrank_skipped_levels(level + 1, E_level, cnt_via_E);
+            odd_parity = odd_parity_via_E;
+            node = E_child;
+            continue;
+        }
+        rank -= cnt_solutions_via_E;
+        set_level_bit(level);
+        int T_child = flat.then_child[node];
+        odd_parity ^= flat.then_complement[node];
+        unrank_skipped_levels(level + 1,
+                              get_node_level(flat, num_levels, T_child),
+                              get_count(T_child, odd_parity));
+        node = T_child;
+    }
+}
+
+template <typename Engine>
+static PackedAssignmentSet
+perform_unranked_sampling(const std::vector<ComponentSampler<Engine>> &samplers,
+                          const std::vector<int> &free_bits,
+                          uint64_t total_solutions, int num_samples, int nI,
+                          unsigned int random_seed) {
+    PackedAssignmentSet assignment_list((nI + 63) / 64);
+    std::seed_seq rank_seed{random_seed};
+    std::mt19937_64 rank_rng(rank_seed);
+    std::vector<uint64_t> assignment_words;
+    for (uint64_t rank :
+         draw_distinct_ranks(total_solutions, num_samples, rank_rng)) {
+        assignment_words.assign((nI + 63) / 64, 0);
+        for (const auto &sampler : samplers) {
+            uint64_t component_solutions = 0;
+            sampler.engine.to_uint64(sampler.counts->target_solutions.data(),
+                                     component_solutions);
+            unrank_component_solution(sampler, rank % component_solutions, nI,
+                                      assignment_words.data());
+            rank /= component_solutions;
+        }
+        for (size_t i = 0; i < free_bits.size(); ++i)
+            if ((rank >> i) & 1)
+                set_packed_bit(assignment_words.data(), free_bits[i]);
+        assignment_list.insert(assignment_words.data());
+    }
+    return assignment_list;
+}
+
+template <typename Engine>
+static PackedAssignmentSet
+perform_bdd_sampling(std::vector<ComponentSampler<Engine>> &samplers,
+                     const std::vector<int> &free_bits, ThreadPool &pool,
+                     int num_samples, int nI, unsigned int random_seed,
+                     bool batch_sampling) {
+    auto sampling_logic_start_time = std::chrono::high_resolution_clock::now();
+    PackedAssignmentSet unique_assignments((nI + 63) / 64);
+    seed_component_samplers(samplers, random_seed);
+    for (const auto &sampler : samplers)
+        if (sampler.engine.is_zero(sampler.counts->target_solutions.data()))
+            return unique_assignments;
+    uint64_t total_solutions = 0;
+    if (get_unrankable_total_solutions(samplers, free_bits, total_solutions))
+        return perform_unranked_sampling(samplers, free_bits, total_solutions,
+                                         num_samples, nI, random_seed);
+    std::seed_seq free_bit_seed{random_seed,
+                                static_cast<unsigned>(samplers.size())};
+    std::mt19937_64 free_bit_rng(free_bit_seed);
+    int samples_successfully_generated = 0;
+    int total_dfs_attempts = 0;
+    const int MAX_TOTAL_DFS_ATTEMPTS = num_samples * 200;
+    std::vector<SampleMatrix> component_draws(samplers.size());
+    std::vector<uint64_t> assignment_words;
+    while (samples_successfully_generated < num_samples &&
+           total_dfs_attempts < MAX_TOTAL_DFS_ATTEMPTS) {
+        int num_draws =
+            std::min(num_samples - samples_successfully_generated,
+                     MAX_TOTAL_DFS_ATTEMPTS - total_dfs_attempts);
+        pool.run_all(samplers.size(), [&](int component_idx) {
+            draw_component_samples(samplers[component_idx], num_draws,
+                                   batch_sampling,
+                                   component_draws[component_idx]);
+        });
+        for (int draw_idx = 0; draw_idx < num_draws &&
+                               samples_successfully_generated < num_samples;
+             ++draw_idx) {
             total_dfs_attempts++;
-            std::map<int, int> current_assignment_cudd_indices;
-            bool current_sample_generation_successful = false;
-            if (nI == 0) {
-                if (bdd_circuit_output == Cudd_ReadOne(manager) &&
-                    !initial_accumulated_odd_complements)
-                    current_sample_generation_successful = true;
-                else
-                    break;
-            } else if (regular_root_bdd == Cudd_ReadOne(manager)) {
-                if (!initial_accumulated_odd_complements)
-                    current_sample_generation_successful = true;
-                else
-                    break;
-            } else if (regular_root_bdd == Cudd_ReadLogicZero(manager))
-                break;
-            else {
-                current_assignment_cudd_indices.clear();
-                current_sample_generation_successful =
-                    generate_random_solution_dfs(
-                        regular_root_bdd, initial_accumulated_odd_complements,
-                        manager, current_assignment_cudd_indices,
-                        dist_float128);
-            }
-            if (current_sample_generation_successful) {
-                json assignment_entry = json::array();
-                int current_bit_idx_overall = 0;
-                for (const auto &var_info : original_variable_list) {
-                    int bit_width = var_info.value("bit_width", 1);
-                    unsigned long long variable_combined_value = 0;
-                    for (int bit_k = 0; bit_k < bit_width; ++bit_k) {
-                        if (current_bit_idx_overall >= nI) {
-                            auto sampling_logic_end_time_fatal =
-                                std::chrono::high_resolution_clock::now();
-                            auto sampling_logic_duration_fatal =
-                                std::chrono::duration_cast<
-                                    std::chrono::milliseconds>(
-                                    sampling_logic_end_time_fatal -
-                                    sampling_logic_start_time);
-                            throw std::runtime_error(
-                                "JSON variable structure inconsistent with AIG "
-                                "nI during sampling.");
-                        }
-                        unsigned long long bit_assignment = 0;
-                        if (nI > 0 &&
-                            current_bit_idx_overall < input_vars_bdd.size()) {
-                            DdNode *pi_bdd_node =
-                                input_vars_bdd[current_bit_idx_overall];
-                            if (pi_bdd_node &&
-                                Cudd_bddIsVar(manager, pi_bdd_node)) {
-                                int cudd_var_idx =
-                                    Cudd_NodeReadIndex(pi_bdd_node);
-                                auto it_assign =
-                                    current_assignment_cudd_indices.find(
-                                        cudd_var_idx);
-                                if (it_assign !=
-                                    current_assignment_cudd_indices.end())
-                                    bit_assignment = it_assign->second;
-                                else
-                                    bit_assignment = 0;
-                            } else
-                                bit_assignment = 0;
-                        }
-                        variable_combined_value |= (bit_assignment << bit_k);
-                        current_bit_idx_overall++;
-                    }
-                    assignment_entry.push_back(
-                        {{"value",
-                          to_hex_string(variable_combined_value, bit_width)}});
-                }
-                std::string assignment_signature = assignment_entry.dump();
-                if (unique_assignment_signatures.insert(assignment_signature)
-                        .second) {
-                    assignment_list.push_back(assignment_entry);
-                    samples_successfully_generated++;
-                }
-            }
+            if (!compose_assignment(samplers, component_draws, draw_idx, nI,
+                                    assignment_words))
+                continue;
+            fill_free_bits(free_bits, free_bit_rng, assignment_words.data());
+            if (unique_assignments.insert(assignment_words.data()))
+                samples_successfully_generated++;
         }
     }
     auto sampling_logic_end_time = std::chrono::high_resolution_clock::now();
     auto sampling_logic_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             sampling_logic_end_time - sampling_logic_start_time);
-    return assignment_list;
+    return unique_assignments;
+}
+
+template <typename Engine>
+static std::vector<double>
+get_else_probabilities(const ComponentSampler<Engine> &sampler) {
+    const FlatBdd &flat = sampler.component->flat;
+    const ComponentCounts<Engine> &counts = *sampler.counts;
+    int num_levels = sampler.component->bdd.bit_indices.size();
+    std::vector<double> else_probabilities(2 * flat.bit_position.size(), 0.0);
+    for (size_t i = 1; i < flat.bit_position.size(); ++i)
+        for (int odd_parity = 0; odd_parity < 2; ++odd_parity) {
+            const typename Engine::Word *total = counts.count(i, odd_parity);
+            if (!sampler.engine.is_zero(total))
+                else_probabilities[2 * i + odd_parity] =
+                    sampler.engine.else_probability(
+                        counts.count(flat.else_child[i],
+                                     odd_parity ^ flat.else_complement[i]),
+                        get_node_level(flat, num_levels, flat.else_child[i]) -
+                            flat.bit_position[i] - 1,
+                        total);
+        }
+    return else_probabilities;
+}
+
+template <typename Engine>
+static void
+benchmark_count_engine(const std::vector<BuiltComponent> &components,
+                       ThreadPool &pool, int num_samples, int nI,
+                       unsigned int random_seed, bool batch_sampling,
+                       std::vector<std::vector<double>>
+                           &reference_probabilities) {
+    std::vector<ComponentSampler<Engine>> samplers;
+    auto count_start_time = std::chrono::high_resolution_clock::now();
+    count_component_solutions(samplers, components, pool);
+    seed_component_samplers(samplers, random_seed);
+    auto count_end_time = std::chrono::high_resolution_clock::now();
+    double log2_total_solutions = 0.0;
+    for (const auto &sampler : samplers)
+        log2_total_solutions +=
+            sampler.engine.log2(sampler.counts->target_solutions.data());
+    if (!std::isfinite(log2_total_solutions)) {
+        std::cout << "engine=" << Engine::name << " unsatisfiable" << std::endl;
+        return;
+    }
+    double max_branch_error = 0.0;
+    for (size_t c = 0; c < samplers.size(); ++c) {
+        if (reference_probabilities.size() < samplers.size())
+            reference_probabilities.push_back(
+                get_else_probabilities(samplers[c]));
+        const std::vector<uint64_t> &else_thresholds =
+            samplers[c].counts->else_thresholds;
+        for (size_t i = 0; i < else_thresholds.size(); ++i)
+            max_branch_error = std::max(
+                max_branch_error,
+                std::fabs(std::ldexp(static_cast<double>(else_thresholds[i]),
+                                     -64) -
+                          reference_probabilities[c][i]));
+    }
+    std::vector<SampleMatrix> component_draws(samplers.size());
+    auto sample_start_time = std::chrono::high_resolution_clock::now();
+    pool.run_all(samplers.size(), [&](int component_idx) {
+        draw_component_samples(samplers[component_idx], num_samples,
+                               batch_sampling, component_draws[component_idx]);
+    });
+    auto sample_end_time = std::chrono::high_resolution_clock::now();
+    std::map<std::vector<uint64_t>, int> assignment_frequencies;
+    std::vector<uint64_t> assignment_words;
+    for (int draw_idx = 0; draw_idx < num_samples; ++draw_idx)
+        if (compose_assignment(samplers, component_draws, draw_idx, nI,
+                               assignment_words))
+            assignment_frequencies[assignment_words]++;
+    std::cout << "engine=" << Engine::name << " count_ms="
+              << std::chrono::duration<double, std::milli>(count_end_time -
+                                                           count_start_time)
+                     .count()
+              << " sample_ms="
+              << std::chrono::duration<double, std::milli>(sample_end_time -
+                                                           sample_start_time)
+                     .count()
+              << " log2_solutions=" << log2_total_solutions
+              << " max_branch_error=" << max_branch_error;
+    if (log2_total_solutions <= 16.0 && num_samples > 0) {
+        double total_solutions = std::round(std::exp2(log2_total_solutions));
+        double expected = num_samples / total_solutions;
+        double chi_square = (total_solutions - assignment_frequencies.size()) *
+                            expected;
+        for (const auto &[bits, observed] : assignment_frequencies)
+            chi_square += (observed - expected) * (observed - expected) /
+                          expected;
+        std::cout << " chi_square=" << chi_square
+                  << " dof=" << total_solutions - 1;
+    } else
+        std::cout << " chi_square=n/a";
+    std::cout << std::endl;
 }
 
 static bool format_and_write_results(const std::string &result_json_path,
-                                     const json &assignment_list) {
+                                     const json &original_variable_list,
+                                     const PackedAssignmentSet &assignment_list,
+                                     const SolverOptions &options) {
     auto json_write_start_time = std::chrono::high_resolution_clock::now();
-    json result_json;
-    result_json["assignment_list"] = assignment_list;
-    std::ofstream output_json_stream(result_json_path);
-    if (!output_json_stream.is_open())
+    std::vector<int> variable_ids;
+    std::vector<int> variable_widths;
+    for (size_t i = 0; i < original_variable_list.size(); ++i) {
+        const json &var_info = original_variable_list[i];
+        variable_ids.push_back(var_info.value("id", static_cast<int>(i)));
+        variable_widths.push_back(std::max(0, var_info.value("bit_width", 1)));
+    }
+    ResultWriter writer(variable_ids, variable_widths);
+    bool written =
+        options.output_format == "binary"
+            ? writer.write_binary(result_json_path, assignment_list.data(),
+                                  assignment_list.size(),
+                                  assignment_list.get_words_per_assignment())
+            : writer.write_json(result_json_path, assignment_list.data(),
+                                assignment_list.size(),
+                                assignment_list.get_words_per_assignment(),
+                                options.pretty_print_results);
+    if (!written)
         return false;
-    output_json_stream << result_json.dump(4) << std::endl;
-    output_json_stream.close();
     auto json_write_end_time = std::chrono::high_resolution_clock::now();
     auto json_write_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -467,72 +1218,547 @@ static bool format_and_write_results(const std::string &result_json_path,
     return true;
 }
 
-static void
-cleanup_cudd_resources(DdManager *manager, DdNode *bdd_circuit_output,
-                       std::map<int, DdNode *> &literal_to_bdd_map) {
-    auto cudd_cleanup_start_time = std::chrono::high_resolution_clock::now();
-    if (bdd_circuit_output)
-        Cudd_RecursiveDeref(manager, bdd_circuit_output);
-    for (auto const &[key, val_node] : literal_to_bdd_map)
+static void release_literal_bdds(DdManager *manager,
+                                 std::vector<DdNode *> &literal_to_bdd_map) {
+    for (DdNode *val_node : literal_to_bdd_map)
         if (val_node)
             Cudd_RecursiveDeref(manager, val_node);
     literal_to_bdd_map.clear();
-    path_counts_memo.clear();
-    if (manager)
-        Cudd_Quit(manager);
+}
+
+static void release_component_manager(BuiltComponent &component) {
+    if (component.bdd.output)
+        Cudd_RecursiveDeref(component.manager, component.bdd.output);
+    component.bdd.output = nullptr;
+    if (component.manager)
+        Cudd_Quit(component.manager);
+    component.manager = nullptr;
+}
+
+static void cleanup_cudd_resources(std::vector<BuiltComponent> &components) {
+    auto cudd_cleanup_start_time = std::chrono::high_resolution_clock::now();
+    for (auto &component : components)
+        release_component_manager(component);
     auto cudd_cleanup_end_time = std::chrono::high_resolution_clock::now();
     auto cudd_cleanup_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             cudd_cleanup_end_time - cudd_cleanup_start_time);
 }
 
-int aig_to_bdd_solver(const string &aig_file_path,
-                      const string &original_json_path, int num_samples,
-                      const string &result_json_path,
-                      unsigned int random_seed) {
-    auto function_start_time = std::chrono::high_resolution_clock::now();
-    rng.seed(random_seed);
-    DdManager *manager = nullptr;
-    DdNode *bdd_circuit_output = nullptr;
-    AigData aig_data;
-    std::map<int, DdNode *> literal_to_bdd_map;
-    std::vector<DdNode *> input_vars_bdd;
-    std::map<int, int> cudd_idx_to_original_aig_pi_file_idx;
-    manager = initialize_cudd_manager();
-    if (!manager)
-        return 1;
-    std::ifstream aig_file_stream(aig_file_path);
-    if (!aig_file_stream.is_open()) {
-        cleanup_cudd_resources(manager, nullptr, literal_to_bdd_map);
-        return 1;
+static void
+benchmark_count_engines(const std::vector<BuiltComponent> &components,
+                        ThreadPool &pool, int num_samples, int nI,
+                        unsigned int random_seed,
+                        const SolverOptions &options) {
+    bool batch_sampling = options.sampler == "batch";
+    std::vector<std::vector<double>> reference_probabilities;
+    benchmark_count_engine<ExactCountEngine>(components, pool, num_samples, nI,
+                                             random_seed, batch_sampling,
+                                             reference_probabilities);
+    benchmark_count_engine<ScaledCountEngine>(components, pool, num_samples,
+                                              nI, random_seed, batch_sampling,
+                                              reference_probabilities);
+    benchmark_count_engine<QuadCountEngine>(components, pool, num_samples, nI,
+                                            random_seed, batch_sampling,
+                                            reference_probabilities);
+}
+
+static bool quantify_auxiliary_inputs(DdManager *manager,
+                                      ComponentBdd &component, int nI) {
+    std::vector<DdNode *> auxiliary_vars;
+    for (size_t k = 0; k < component.bit_indices.size(); ++k)
+        if (component.bit_indices[k] >= nI)
+            auxiliary_vars.push_back(component.input_vars[k]);
+    if (auxiliary_vars.empty())
+        return true;
+    DdNode *cube = Cudd_bddComputeCube(manager, auxiliary_vars.data(), nullptr,
+                                       auxiliary_vars.size());
+    if (!cube)
+        return false;
+    Cudd_Ref(cube);
+    DdNode *quantified =
+        Cudd_bddExistAbstract(manager, component.output, cube);
+    if (quantified)
+        Cudd_Ref(quantified);
+    Cudd_RecursiveDeref(manager, cube);
+    if (!quantified)
+        return false;
+    Cudd_RecursiveDeref(manager, component.output);
+    component.output = quantified;
+    return true;
+}
+
+// Keeps only support inputs, in level order. Support variables a path skips
+// are counted and filled like free bits, per level gap.
+static void restrict_to_support(DdManager *manager, ComponentBdd &component) {
+    std::vector<bool> in_support(Cudd_ReadSize(manager), false);
+    for (int index : get_support_indices(manager, component.output))
+        in_support[index] = true;
+    std::vector<std::pair<int, size_t>> kept_inputs;
+    for (size_t k = 0; k < component.input_vars.size(); ++k) {
+        int index = Cudd_NodeReadIndex(component.input_vars[k]);
+        if (in_support[index])
+            kept_inputs.push_back({Cudd_ReadPerm(manager, index), k});
     }
-    if (!parse_aig_header(aig_file_stream, aig_data)) {
-        aig_file_stream.close();
-        cleanup_cudd_resources(manager, nullptr, literal_to_bdd_map);
-        return 1;
+    std::sort(kept_inputs.begin(), kept_inputs.end());
+    std::vector<DdNode *> input_vars;
+    std::vector<int> bit_indices;
+    for (const auto &[level, k] : kept_inputs) {
+        input_vars.push_back(component.input_vars[k]);
+        bit_indices.push_back(component.bit_indices[k]);
     }
-    if (!read_aig_structure(aig_file_stream, aig_data)) {
-        aig_file_stream.close();
-        cleanup_cudd_resources(manager, nullptr, literal_to_bdd_map);
-        return 1;
+    component.input_vars = std::move(input_vars);
+    component.bit_indices = std::move(bit_indices);
+}
+
+static std::vector<int>
+get_free_bits(const std::vector<BuiltComponent> &components, int nI) {
+    std::vector<bool> constrained(nI, false);
+    for (const auto &component : components)
+        for (int bit_idx : component.bdd.bit_indices)
+            if (bit_idx < nI)
+                constrained[bit_idx] = true;
+    std::vector<int> free_bits;
+    for (int bit_idx = 0; bit_idx < nI; ++bit_idx)
+        if (!constrained[bit_idx])
+            free_bits.push_back(bit_idx);
+    return free_bits;
+}
+
+struct CompiledConstraints {
+    std::vector<BuiltComponent> components;
+    json original_variable_list;
+    int nI = 0;
+    std::vector<int> free_bits;
+    bool infeasible = false;
+    std::vector<ComponentSampler<ExactCountEngine>> exact_samplers;
+    std::vector<ComponentSampler<ScaledCountEngine>> scaled_samplers;
+    std::vector<ComponentSampler<QuadCountEngine>> quad_samplers;
+
+    ~CompiledConstraints() { cleanup_cudd_resources(components); }
+
+    template <typename Engine>
+    std::vector<ComponentSampler<Engine>> &get_samplers() {
+        if constexpr (std::is_same_v<Engine, ScaledCountEngine>)
+            return scaled_samplers;
+        else if constexpr (std::is_same_v<Engine, QuadCountEngine>)
+            return quad_samplers;
+        else
+            return exact_samplers;
     }
-    aig_file_stream.close();
-    if (!create_bdd_variables(manager, aig_data, literal_to_bdd_map,
-                              input_vars_bdd,
-                              cudd_idx_to_original_aig_pi_file_idx)) {
-        cleanup_cudd_resources(manager, nullptr, literal_to_bdd_map);
-        return 1;
+};
+
+template <typename Engine>
+static std::vector<char>
+sample_with_cached_counts(CompiledConstraints &compiled, ThreadPool &pool,
+                          const std::vector<SamplingJob> &jobs,
+                          const SolverOptions &options) {
+    std::vector<ComponentSampler<Engine>> &samplers =
+        compiled.get_samplers<Engine>();
+    if (samplers.size() != compiled.components.size())
+        count_component_solutions(samplers, compiled.components, pool);
+    bool batch_sampling = options.sampler == "batch";
+    std::vector<char> written(jobs.size(), 0);
+    auto run_job = [&](int job_idx, ThreadPool &component_pool) {
+        const SamplingJob &job = jobs[job_idx];
+        std::vector<ComponentSampler<Engine>> job_samplers = samplers;
+        PackedAssignmentSet assignment_list = perform_bdd_sampling(
+            job_samplers, compiled.free_bits, component_pool, job.num_samples,
+            compiled.nI, job.random_seed, batch_sampling);
+        written[job_idx] = format_and_write_results(
+            job.result_path, compiled.original_variable_list, assignment_list,
+            options);
+    };
+    int num_job_threads =
+        std::min(options.num_threads, static_cast<int>(jobs.size()));
+    if (num_job_threads <= 1) {
+        for (size_t job_idx = 0; job_idx < jobs.size(); ++job_idx)
+            run_job(job_idx, pool);
+        return written;
     }
-    if (!build_bdd_for_and_gates(manager, aig_data, literal_to_bdd_map)) {
-        cleanup_cudd_resources(manager, nullptr, literal_to_bdd_map);
-        return 1;
+    ThreadPool job_pool(num_job_threads);
+    job_pool.run_all(jobs.size(), [&](int job_idx) {
+        ThreadPool component_pool(std::min(
+            std::max(1, options.num_threads / num_job_threads),
+            std::max(1, static_cast<int>(samplers.size()))));
+        run_job(job_idx, component_pool);
+    });
+    return written;
+}
+
+static std::vector<char>
+sample_with_count_engine(CompiledConstraints &compiled, ThreadPool &pool,
+                         const std::vector<SamplingJob> &jobs,
+                         const SolverOptions &options) {
+    if (options.count_engine == ScaledCountEngine::name)
+        return sample_with_cached_counts<ScaledCountEngine>(compiled, pool,
+                                                            jobs, options);
+    if (options.count_engine == QuadCountEngine::name)
+        return sample_with_cached_counts<QuadCountEngine>(compiled, pool, jobs,
+                                                          options);
+    return sample_with_cached_counts<ExactCountEngine>(compiled, pool, jobs,
+                                                       options);
+}
+
+std::shared_ptr<CompiledConstraints>
+compile_components(int num_components, const ComponentBuilder &build_component,
+                   const json &original_variable_list,
+                   const SolverOptions &options) {
+    auto compiled = std::make_shared<CompiledConstraints>();
+    compiled->original_variable_list = original_variable_list;
+    int &nI = compiled->nI;
+    for (const auto &var_info : original_variable_list)
+        nI += var_info.value("bit_width", 1);
+    std::vector<BuiltComponent> &components = compiled->components;
+    components.resize(num_components);
+    ThreadPool pool(std::min(options.num_threads, std::max(1, num_components)));
+    std::atomic<bool> infeasible(false);
+    try {
+        pool.run_all(num_components, [&](int component_idx) {
+            if (infeasible)
+                return;
+            BuiltComponent &component = components[component_idx];
+            component.reorder_monitor.component_idx = component_idx;
+            component.manager = initialize_cudd_manager();
+            if (!component.manager ||
+                !configure_reordering(component.manager, options,
+                                      component.reorder_monitor) ||
+                !build_component(component_idx, component.manager,
+                                 component.bdd) ||
+                !component.bdd.output)
+                return;
+            if (component.bdd.output ==
+                Cudd_ReadLogicZero(component.manager)) {
+                infeasible = true;
+                return;
+            }
+            if (!quantify_auxiliary_inputs(component.manager, component.bdd,
+                                           nI) ||
+                !converge_final_order(component.manager, options))
+                return;
+            restrict_to_support(component.manager, component.bdd);
+            component.flat =
+                flatten_component_bdd(component.manager, component.bdd);
+            component.num_manager_vars = Cudd_ReadSize(component.manager);
+            release_component_manager(component);
+            component.built = true;
+        });
+    } catch (const std::exception &e) {
+        return nullptr;
     }
-    bdd_circuit_output =
-        get_final_bdd_output(manager, aig_data, literal_to_bdd_map);
-    if (!bdd_circuit_output) {
-        cleanup_cudd_resources(manager, bdd_circuit_output, literal_to_bdd_map);
-        return 1;
+    compiled->infeasible = infeasible;
+    if (compiled->infeasible) {
+        cleanup_cudd_resources(components);
+        components.clear();
+        return compiled;
     }
+    for (const auto &component : components)
+        if (!component.built)
+            return nullptr;
+    compiled->free_bits = get_free_bits(components, nI);
+    return compiled;
+}
+
+int sample_compiled_jobs(CompiledConstraints &compiled,
+                         const std::vector<SamplingJob> &jobs,
+                         const SolverOptions &options) {
+    std::vector<char> written(jobs.size(), 0);
+    if (compiled.infeasible) {
+        PackedAssignmentSet assignment_list((compiled.nI + 63) / 64);
+        for (size_t job_idx = 0; job_idx < jobs.size(); ++job_idx)
+            written[job_idx] = format_and_write_results(
+                jobs[job_idx].result_path, compiled.original_variable_list,
+                assignment_list, options);
+    } else {
+        ThreadPool pool(std::min(options.num_threads,
+                                 std::max(1, static_cast<int>(
+                                                 compiled.components.size()))));
+        try {
+            if (options.benchmark_count_engines)
+                for (const SamplingJob &job : jobs)
+                    benchmark_count_engines(compiled.components, pool,
+                                            job.num_samples, compiled.nI,
+                                            job.random_seed, options);
+            written = sample_with_count_engine(compiled, pool, jobs, options);
+        } catch (const std::exception &e) {
+            return 1;
+        }
+    }
+    for (char job_written : written)
+        if (!job_written)
+            return 1;
+    return 0;
+}
+
+int sample_compiled_constraints(CompiledConstraints &compiled, int num_samples,
+                                const string &result_json_path,
+                                unsigned int random_seed,
+                                const SolverOptions &options) {
+    return sample_compiled_jobs(
+        compiled, {{random_seed, num_samples, result_json_path}}, options);
+}
+
+const char COMPILED_CACHE_MAGIC[8] = {'S', 'V', 'C', 'O', 'M', 'P', 'I', 'L'};
+const uint32_t COMPILED_CACHE_VERSION = 2;
+// Bump whenever lowering, ordering or BDD construction changes so that
+// entries written by older solvers stop matching.
+const uint32_t COMPILER_SEMANTICS_VERSION = 1;
+
+uint64_t hash_content(std::string_view content, uint64_t hash) {
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string get_compile_options_key(const SolverOptions &options) {
+    std::ostringstream key;
+    key << options.variable_order << ' ' << options.order_probe_node_limit
+        << ' ' << options.variable_groups << ' ' << options.conjoin_schedule
+        << ' ' << options.reorder_method << ' ' << options.reorder_max_growth
+        << ' ' << options.reorder_first_threshold << ' '
+        << options.reorder_max_count << ' ' << options.reorder_time_budget_ms
+        << ' ' << options.final_reorder;
+    return key.str();
+}
+
+template <typename T> static void append_raw(std::string &out, T value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static void append_array(std::string &out, const std::vector<T> &values) {
+    append_raw(out, static_cast<uint32_t>(values.size()));
+    out.append(reinterpret_cast<const char *>(values.data()),
+               values.size() * sizeof(T));
+}
+
+class CacheReader {
+  public:
+    CacheReader(const char *begin, const char *end) : pos(begin), end(end) {}
+
+    template <typename T> bool read(T &value) {
+        if (static_cast<size_t>(end - pos) < sizeof(T))
+            return false;
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    template <typename T> bool read_array(std::vector<T> &values) {
+        uint32_t size = 0;
+        if (!read(size) || static_cast<size_t>(end - pos) / sizeof(T) < size)
+            return false;
+        values.resize(size);
+        std::memcpy(values.data(), pos, size * sizeof(T));
+        pos += size * sizeof(T);
+        return true;
+    }
+
+    bool at_end() const { return pos == end; }
+
+  private:
+    const char *pos;
+    const char *end;
+};
+
+static bool save_compiled_constraints(const CompiledConstraints &compiled,
+                                      const std::filesystem::path &cache_path,
+                                      uint64_t key_check) {
+    std::string out(COMPILED_CACHE_MAGIC, sizeof(COMPILED_CACHE_MAGIC));
+    append_raw(out, COMPILED_CACHE_VERSION);
+    append_raw(out, key_check);
+    append_raw(out, static_cast<int32_t>(compiled.nI));
+    append_raw(out, static_cast<uint8_t>(compiled.infeasible));
+    append_array(out, compiled.free_bits);
+    append_raw(out, static_cast<uint32_t>(compiled.components.size()));
+    for (const auto &component : compiled.components) {
+        append_raw(out, static_cast<int32_t>(component.num_manager_vars));
+        append_raw(out, static_cast<int32_t>(component.flat.root));
+        append_raw(out, static_cast<uint8_t>(component.flat.root_complement));
+        append_array(out, component.bdd.bit_indices);
+        append_array(out, component.flat.bit_position);
+        append_array(out, component.flat.else_child);
+        append_array(out, component.flat.then_child);
+        append_array(out, component.flat.else_complement);
+        append_array(out, component.flat.then_complement);
+    }
+    std::error_code error;
+    std::filesystem::create_directories(cache_path.parent_path(), error);
+    std::filesystem::path temp_path = cache_path;
+    temp_path += ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream cache_stream(temp_path, std::ios::binary);
+        if (!cache_stream.write(out.data(), out.size()))
+            return false;
+    }
+    std::filesystem::rename(temp_path, cache_path, error);
+    if (error)
+        std::filesystem::remove(temp_path, error);
+    return !error;
+}
+
+static bool is_valid_flat_bdd(const FlatBdd &flat, int num_bits) {
+    size_t num_nodes = flat.bit_position.size();
+    if (num_nodes == 0 || flat.else_child.size() != num_nodes ||
+        flat.then_child.size() != num_nodes ||
+        flat.else_complement.size() != num_nodes ||
+        flat.then_complement.size() != num_nodes || flat.root < 0 ||
+        static_cast<size_t>(flat.root) >= num_nodes)
+        return false;
+    for (size_t i = 1; i < num_nodes; ++i)
+        if (flat.bit_position[i] < 0 || flat.bit_position[i] >= num_bits ||
+            flat.else_child[i] < 0 ||
+            static_cast<size_t>(flat.else_child[i]) >= i ||
+            flat.then_child[i] < 0 ||
+            static_cast<size_t>(flat.then_child[i]) >= i ||
+            get_node_level(flat, num_bits, flat.else_child[i]) <=
+                flat.bit_position[i] ||
+            get_node_level(flat, num_bits, flat.then_child[i]) <=
+                flat.bit_position[i])
+            return false;
+    return true;
+}
+
+static std::shared_ptr<CompiledConstraints>
+load_compiled_constraints(const std::filesystem::path &cache_path,
+                          uint64_t key_check,
+                          const json &original_variable_list) {
+    MappedFile cache_file(cache_path.string());
+    if (!cache_file.is_open())
+        return nullptr;
+    CacheReader reader(cache_file.begin(), cache_file.end());
+    char magic[sizeof(COMPILED_CACHE_MAGIC)];
+    uint32_t version = 0;
+    uint64_t stored_key_check = 0;
+    int32_t nI = 0;
+    uint8_t infeasible = 0;
+    uint32_t num_components = 0;
+    auto compiled = std::make_shared<CompiledConstraints>();
+    if (!reader.read(magic) || !reader.read(version) ||
+        !reader.read(stored_key_check) || !reader.read(nI) ||
+        !reader.read(infeasible) || !reader.read_array(compiled->free_bits) ||
+        !reader.read(num_components) ||
+        std::memcmp(magic, COMPILED_CACHE_MAGIC, sizeof(magic)) != 0 ||
+        version != COMPILED_CACHE_VERSION || stored_key_check != key_check)
+        return nullptr;
+    compiled->original_variable_list = original_variable_list;
+    compiled->nI = nI;
+    compiled->infeasible = infeasible != 0;
+    for (int bit_idx : compiled->free_bits)
+        if (bit_idx < 0 || bit_idx >= nI)
+            return nullptr;
+    for (uint32_t c = 0; c < num_components; ++c) {
+        BuiltComponent component;
+        int32_t num_manager_vars = 0;
+        int32_t root = 0;
+        uint8_t root_complement = 0;
+        if (!reader.read(num_manager_vars) || !reader.read(root) ||
+            !reader.read(root_complement) ||
+            !reader.read_array(component.bdd.bit_indices) ||
+            !reader.read_array(component.flat.bit_position) ||
+            !reader.read_array(component.flat.else_child) ||
+            !reader.read_array(component.flat.then_child) ||
+            !reader.read_array(component.flat.else_complement) ||
+            !reader.read_array(component.flat.then_complement))
+            return nullptr;
+        component.num_manager_vars = num_manager_vars;
+        component.flat.root = root;
+        component.flat.root_complement = root_complement != 0;
+        for (int bit_idx : component.bdd.bit_indices)
+            if (bit_idx < 0 || bit_idx >= nI)
+                return nullptr;
+        if (!is_valid_flat_bdd(component.flat,
+                               component.bdd.bit_indices.size()))
+            return nullptr;
+        component.built = true;
+        compiled->components.push_back(std::move(component));
+    }
+    return reader.at_end() ? compiled : nullptr;
+}
+
+std::shared_ptr<CompiledConstraints> load_or_compile_constraints(
+    const json &data, const std::string &flow, const SolverOptions &options,
+    const std::function<std::shared_ptr<CompiledConstraints>()> &compile) {
+    if (options.cache_dir.empty() || !data.contains("variable_list"))
+        return options.cache_lookup_only ? nullptr : compile();
+    std::string key = flow + '\n' +
+                      std::to_string(COMPILER_SEMANTICS_VERSION) + '\n' +
+                      get_compile_options_key(options) + '\n' + data.dump();
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "%016llx.bdd",
+                  static_cast<unsigned long long>(hash_content(key)));
+    std::filesystem::path cache_path =
+        std::filesystem::path(options.cache_dir) / file_name;
+    uint64_t key_check = hash_content(key, 0x84222325cbf29ce4ULL);
+    std::shared_ptr<CompiledConstraints> compiled = load_compiled_constraints(
+        cache_path, key_check, data["variable_list"]);
+    if (compiled || options.cache_lookup_only)
+        return compiled;
+    compiled = compile();
+    if (compiled)
+        save_compiled_constraints(*compiled, cache_path, key_check);
+    return compiled;
+}
+
+std::shared_ptr<CompiledConstraints>
+compile_aig_data(const AigData &aig_data, const json &original_variable_list,
+                 const InputLayout &input_layout,
+                 const SolverOptions &options) {
+    if (aig_data.nO <= 0)
+        return nullptr;
+    std::vector<SupportSet> var_supports = compute_var_supports(aig_data);
+    std::vector<std::vector<int>> component_output_literals =
+        get_output_components(aig_data, var_supports);
+    ComponentBuilder build_component = [&](int component_idx,
+                                           DdManager *manager,
+                                           ComponentBdd &component) {
+        const std::vector<int> &output_literals =
+            component_output_literals[component_idx];
+        std::vector<bool> in_cone =
+            get_cone_of_influence(aig_data, output_literals);
+        std::vector<int> ordered_inputs;
+        for (int pi_lit : determine_bdd_variable_order(
+                 aig_data, var_supports, output_literals, in_cone,
+                 input_layout.interleaved_bit_order, options))
+            ordered_inputs.push_back(aig_data.input_index_by_var[pi_lit / 2]);
+        std::vector<std::vector<int>> input_groups = group_input_order(
+            ordered_inputs, input_layout, options.variable_groups);
+        std::vector<int> ordered_pi_literals;
+        for (const auto &input_group : input_groups)
+            for (int input_idx : input_group)
+                ordered_pi_literals.push_back(
+                    aig_data.primary_input_literals[input_idx]);
+        std::vector<DdNode *> literal_to_bdd_map(2 * (aig_data.nM + 1),
+                                                 nullptr);
+        bool infeasible = false;
+        bool build_successful =
+            create_bdd_variables(manager, aig_data, ordered_pi_literals,
+                                 literal_to_bdd_map, component) &&
+            register_variable_groups(manager, input_groups) &&
+            build_bdd_for_and_gates(manager, aig_data, in_cone,
+                                    output_literals, literal_to_bdd_map,
+                                    infeasible);
+        if (build_successful && infeasible) {
+            component.output = Cudd_ReadLogicZero(manager);
+            Cudd_Ref(component.output);
+        } else if (build_successful)
+            component.output = get_component_bdd_output(
+                manager, output_literals, literal_to_bdd_map,
+                options.conjoin_schedule);
+        release_literal_bdds(manager, literal_to_bdd_map);
+        return build_successful && component.output;
+    };
+    return compile_components(
+        static_cast<int>(component_output_literals.size()), build_component,
+        original_variable_list, options);
+}
+
+int aig_to_bdd_solver(const string &aig_file_path,
+                      const string &original_json_path,
+                      const std::vector<SamplingJob> &jobs,
+                      const SolverOptions &options) {
     auto original_json_read_start_time =
         std::chrono::high_resolution_clock::now();
     ifstream original_json_stream(original_json_path);
@@ -549,28 +1775,26 @@ int aig_to_bdd_solver(const string &aig_file_path,
     auto original_json_read_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             original_json_read_end_time - original_json_read_start_time);
-    json assignment_list;
-    try {
-        assignment_list = perform_bdd_sampling(
-            manager, bdd_circuit_output, num_samples, aig_data.nI,
-            original_variable_list, input_vars_bdd,
-            cudd_idx_to_original_aig_pi_file_idx);
-    } catch (const std::runtime_error &e) {
-        cleanup_cudd_resources(manager, bdd_circuit_output, literal_to_bdd_map);
+    MappedFile aig_file(aig_file_path);
+    if (!aig_file.is_open())
         return 1;
-    }
-    if (!format_and_write_results(result_json_path, assignment_list)) {
-        cleanup_cudd_resources(manager, bdd_circuit_output, literal_to_bdd_map);
+    uint64_t aig_hash = hash_content(
+        std::string_view(aig_file.begin(), aig_file.end() - aig_file.begin()));
+    std::shared_ptr<CompiledConstraints> compiled = load_or_compile_constraints(
+        original_data, "yosys " + std::to_string(aig_hash), options,
+        [&]() -> std::shared_ptr<CompiledConstraints> {
+            AigData aig_data;
+            const char *pos = aig_file.begin();
+            bool is_binary = false;
+            if (!parse_aig_header(pos, aig_file.end(), aig_data, is_binary) ||
+                !read_aig_structure(pos, aig_file.end(), is_binary, aig_data))
+                return nullptr;
+            return compile_aig_data(aig_data, original_variable_list,
+                                    get_input_layout(original_data), options);
+        });
+    if (!compiled)
         return 1;
-    }
-    cleanup_cudd_resources(manager, bdd_circuit_output, literal_to_bdd_map);
-    manager = nullptr;
-    bdd_circuit_output = nullptr;
-    auto function_end_time = std::chrono::high_resolution_clock::now();
-    auto function_duration =
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            function_end_time - function_start_time);
-    return 0;
+    return sample_compiled_jobs(*compiled, jobs, options);
 }
 
 string to_hex_string(unsigned long long value, int bit_width) {
@@ -592,131 +1816,3 @@ string to_hex_string(unsigned long long value, int bit_width) {
         hex_str = hex_str.substr(hex_str.length() - hex_chars);
     return hex_str;
 }
-
-static void get_pi_support_for_node_dfs_recursive(
-    int current_literal,
-    const std::map<int, std::pair<int, int>> &and_gate_definitions,
-    const std::set<int> &all_pi_literals_set, std::set<int> &node_pi_support,
-    std::set<int> &visited_for_this_support_dfs,
-    std::map<int, std::set<int>> &memoized_supports);
-
-static std::set<int>
-get_pi_support(int literal,
-               const std::map<int, std::pair<int, int>> &and_gate_definitions,
-               const std::set<int> &all_pi_literals_set,
-               std::map<int, std::set<int>> &memoized_supports) {
-    int regular_lit = (literal / 2) * 2;
-    if (regular_lit == 0 || regular_lit == 1)
-        return {};
-    auto memo_it = memoized_supports.find(regular_lit);
-    if (memo_it != memoized_supports.end())
-        return memo_it->second;
-    std::set<int> support;
-    std::set<int> visited_dfs_for_this_call;
-    get_pi_support_for_node_dfs_recursive(
-        regular_lit, and_gate_definitions, all_pi_literals_set, support,
-        visited_dfs_for_this_call, memoized_supports);
-    memoized_supports[regular_lit] = support;
-    return support;
-}
-
-static void get_pi_support_for_node_dfs_recursive(
-    int current_literal,
-    const std::map<int, std::pair<int, int>> &and_gate_definitions,
-    const std::set<int> &all_pi_literals_set, std::set<int> &node_pi_support,
-    std::set<int> &visited_for_this_support_dfs,
-    std::map<int, std::set<int>> &memoized_supports) {
-    int regular_literal = (current_literal / 2) * 2;
-    if (regular_literal == 0 || regular_literal == 1)
-        return;
-    if (visited_for_this_support_dfs.count(regular_literal))
-        return;
-    visited_for_this_support_dfs.insert(regular_literal);
-    if (all_pi_literals_set.count(regular_literal)) {
-        node_pi_support.insert(regular_literal);
-        if (memoized_supports.find(regular_literal) == memoized_supports.end())
-            memoized_supports[regular_literal] = {regular_literal};
-        return;
-    }
-    auto memo_it = memoized_supports.find(regular_literal);
-    if (memo_it != memoized_supports.end()) {
-        const auto &cached_support = memo_it->second;
-        node_pi_support.insert(cached_support.begin(), cached_support.end());
-        return;
-    }
-    auto it_and_def = and_gate_definitions.find(regular_literal);
-    if (it_and_def != and_gate_definitions.end()) {
-        const auto &inputs = it_and_def->second;
-        std::set<int> support1 =
-            get_pi_support(inputs.first, and_gate_definitions,
-                           all_pi_literals_set, memoized_supports);
-        std::set<int> support2 =
-            get_pi_support(inputs.second, and_gate_definitions,
-                           all_pi_literals_set, memoized_supports);
-        node_pi_support.insert(support1.begin(), support1.end());
-        node_pi_support.insert(support2.begin(), support2.end());
-    }
-}
-
-static std::vector<int> determine_bdd_variable_order(
-    int nI_total_from_header,
-    const std::vector<int> &aig_primary_input_literals,
-    const std::vector<int> &circuit_output_literals_from_aig,
-    const std::map<int, std::pair<int, int>> &and_gate_definitions) {
-    std::vector<int> ordered_pis_for_bdd_creation;
-    std::set<int> added_pis_to_final_order_set;
-    std::set<int> all_pi_literals_set;
-    for (int pi_lit : aig_primary_input_literals)
-        all_pi_literals_set.insert((pi_lit / 2) * 2);
-    std::map<int, std::set<int>> memoized_pi_supports;
-    std::set<int> visited_nodes_for_ordering_dfs;
-    std::function<void(int)> order_dfs_main = [&](int current_node_literal) {
-        int regular_node_lit = (current_node_literal / 2) * 2;
-        if (regular_node_lit == 0 || regular_node_lit == 1)
-            return;
-        if (visited_nodes_for_ordering_dfs.count(regular_node_lit))
-            return;
-        visited_nodes_for_ordering_dfs.insert(regular_node_lit);
-        if (all_pi_literals_set.count(regular_node_lit)) {
-            if (added_pis_to_final_order_set.find(regular_node_lit) ==
-                added_pis_to_final_order_set.end()) {
-                ordered_pis_for_bdd_creation.push_back(regular_node_lit);
-                added_pis_to_final_order_set.insert(regular_node_lit);
-            }
-            return;
-        }
-        auto it_and = and_gate_definitions.find(regular_node_lit);
-        if (it_and != and_gate_definitions.end()) {
-            const auto &inputs = it_and->second;
-            std::set<int> support1 =
-                get_pi_support(inputs.first, and_gate_definitions,
-                               all_pi_literals_set, memoized_pi_supports);
-            std::set<int> support2 =
-                get_pi_support(inputs.second, and_gate_definitions,
-                               all_pi_literals_set, memoized_pi_supports);
-            if (support1.size() <= support2.size()) {
-                order_dfs_main(inputs.first);
-                order_dfs_main(inputs.second);
-            } else {
-                order_dfs_main(inputs.second);
-                order_dfs_main(inputs.first);
-            }
-        }
-    };
-    if (!circuit_output_literals_from_aig.empty())
-        for (int po_lit : circuit_output_literals_from_aig) {
-            if (po_lit == 0 || po_lit == 1)
-                continue;
-            order_dfs_main(po_lit);
-        }
-    for (int pi_lit_from_file : aig_primary_input_literals) {
-        int regular_pi_lit = (pi_lit_from_file / 2) * 2;
-        if (all_pi_literals_set.count(regular_pi_lit))
-            if (added_pis_to_final_order_set.find(regular_pi_lit) ==
-                added_pis_to_final_order_set.end()) {
-                ordered_pis_for_bdd_creation.push_back(regular_pi_lit);
-                added_pis_to_final_order_set.insert(regular_pi_lit);
-            }
-    }
-    return ordered_pis_for_bdd_creation;
-}
\ No newline at end of file
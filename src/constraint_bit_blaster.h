@@ -0,0 +1,288 @@
+#ifndef CONSTRAINT_BIT_BLASTER_H
+#define CONSTRAINT_BIT_BLASTER_H
+
+#include "expression_graph.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+inline void collect_variable_ids(const nlohmann::json &node,
+                                 std::vector<int> &ids) {
+    if (node["op"] == "VAR") {
+        int id = node.value("id", 0);
+        if (std::find(ids.begin(), ids.end(), id) == ids.end())
+            ids.push_back(id);
+        return;
+    }
+    for (const char *child :
+         {"pred_expression", "lhs_expression", "rhs_expression"})
+        if (node.contains(child))
+            collect_variable_ids(node[child], ids);
+}
+
+template <typename Builder> class ConstraintBitBlaster {
+  public:
+    using Literal = typename Builder::Literal;
+    using BitVector = std::vector<Literal>;
+
+    ConstraintBitBlaster(Builder &bit_builder,
+                         const ExpressionGraph &expression_graph,
+                         const nlohmann::json &variable_list)
+        : builder(bit_builder), graph(expression_graph) {
+        for (size_t i = 0; i < variable_list.size(); ++i) {
+            const auto &var = variable_list[i];
+            int id = var.value("id", static_cast<int>(i));
+            int bit_width = var.value("bit_width", 1);
+            BitVector bits;
+            for (int k = 0; k < bit_width; ++k)
+                bits.push_back(builder.create_input());
+            variable_bits[id] = bits;
+        }
+    }
+
+    Literal blast_constraint(int root) { return reduce_or(blast(root)); }
+
+    void clear_cache() { node_bits.clear(); }
+
+  private:
+    Builder &builder;
+    const ExpressionGraph &graph;
+    std::map<int, BitVector> variable_bits;
+    std::unordered_map<int, BitVector> node_bits;
+
+    BitVector resize(BitVector bits, int width) {
+        bits.resize(width, builder.constant(false));
+        return bits;
+    }
+
+    BitVector constant_vector(const std::vector<bool> &bits, int width) {
+        BitVector result(width, builder.constant(false));
+        for (int i = 0; i < width && i < static_cast<int>(bits.size()); ++i)
+            result[i] = builder.constant(bits[i]);
+        return result;
+    }
+
+    Literal reduce_or(const BitVector &bits) {
+        Literal result = builder.constant(false);
+        for (Literal bit : bits)
+            result = builder.create_or(result, bit);
+        return result;
+    }
+
+    BitVector add(const BitVector &lhs, const BitVector &rhs, Literal carry,
+                  Literal *carry_out = nullptr) {
+        BitVector sum(lhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            Literal half_sum = builder.create_xor(lhs[i], rhs[i]);
+            sum[i] = builder.create_xor(half_sum, carry);
+            carry = builder.create_or(builder.create_and(lhs[i], rhs[i]),
+                                      builder.create_and(half_sum, carry));
+        }
+        if (carry_out)
+            *carry_out = carry;
+        return sum;
+    }
+
+    BitVector subtract(const BitVector &lhs, const BitVector &rhs,
+                       Literal *borrow_out = nullptr) {
+        BitVector inverted_rhs(rhs.size());
+        for (size_t i = 0; i < rhs.size(); ++i)
+            inverted_rhs[i] = builder.negate(rhs[i]);
+        Literal carry_out = builder.constant(true);
+        BitVector difference =
+            add(lhs, inverted_rhs, builder.constant(true), &carry_out);
+        if (borrow_out)
+            *borrow_out = builder.negate(carry_out);
+        return difference;
+    }
+
+    BitVector multiply(const BitVector &lhs, const BitVector &rhs) {
+        int width = static_cast<int>(lhs.size());
+        BitVector product(width, builder.constant(false));
+        for (int i = 0; i < width; ++i) {
+            BitVector partial(width, builder.constant(false));
+            for (int j = i; j < width; ++j)
+                partial[j] = builder.create_and(lhs[j - i], rhs[i]);
+            product = add(product, partial, builder.constant(false));
+        }
+        return product;
+    }
+
+    void divide(const BitVector &dividend, const BitVector &divisor,
+                BitVector &quotient, BitVector &remainder) {
+        int width = static_cast<int>(dividend.size());
+        BitVector extended_divisor = resize(divisor, width + 1);
+        quotient.assign(width, builder.constant(false));
+        remainder.assign(width, builder.constant(false));
+        for (int i = width - 1; i >= 0; --i) {
+            BitVector shifted_remainder;
+            shifted_remainder.push_back(dividend[i]);
+            shifted_remainder.insert(shifted_remainder.end(),
+                                     remainder.begin(), remainder.end());
+            Literal borrow = builder.constant(false);
+            BitVector difference =
+                subtract(shifted_remainder, extended_divisor, &borrow);
+            quotient[i] = builder.negate(borrow);
+            for (int k = 0; k < width; ++k)
+                remainder[k] = builder.create_mux(quotient[i], difference[k],
+                                                  shifted_remainder[k]);
+        }
+    }
+
+    BitVector shift(const BitVector &value, const BitVector &amount,
+                    bool shift_left) {
+        int width = static_cast<int>(value.size());
+        BitVector result = value;
+        Literal shifted_out_completely = builder.constant(false);
+        for (size_t k = 0; k < amount.size(); ++k) {
+            if (k >= 31 || (1LL << k) >= width) {
+                shifted_out_completely =
+                    builder.create_or(shifted_out_completely, amount[k]);
+                continue;
+            }
+            int step = 1 << k;
+            BitVector stage(width);
+            for (int j = 0; j < width; ++j) {
+                int source = shift_left ? j - step : j + step;
+                Literal shifted_bit = (source >= 0 && source < width)
+                                          ? result[source]
+                                          : builder.constant(false);
+                stage[j] =
+                    builder.create_mux(amount[k], shifted_bit, result[j]);
+            }
+            result = stage;
+        }
+        for (int j = 0; j < width; ++j)
+            result[j] = builder.create_and(
+                result[j], builder.negate(shifted_out_completely));
+        return result;
+    }
+
+    Literal equal(const BitVector &lhs, const BitVector &rhs) {
+        Literal result = builder.constant(true);
+        for (size_t i = 0; i < lhs.size(); ++i)
+            result = builder.create_and(
+                result, builder.negate(builder.create_xor(lhs[i], rhs[i])));
+        return result;
+    }
+
+    Literal less_than(const BitVector &lhs, const BitVector &rhs) {
+        Literal result = builder.constant(false);
+        for (size_t i = 0; i < lhs.size(); ++i)
+            result = builder.create_mux(builder.create_xor(lhs[i], rhs[i]),
+                                        rhs[i], result);
+        return result;
+    }
+
+    const BitVector &blast(int id) {
+        auto it = node_bits.find(id);
+        if (it != node_bits.end())
+            return it->second;
+        BitVector bits = blast_node(graph.node(id));
+        return node_bits.emplace(id, std::move(bits)).first->second;
+    }
+
+    BitVector operand(const ExprNode &node, int k, int width) {
+        return resize(blast(node.operands[k]), width);
+    }
+
+    Literal operand_is_true(const ExprNode &node, int k) {
+        return reduce_or(blast(node.operands[k]));
+    }
+
+    BitVector blast_node(const ExprNode &node) {
+        int width = node.width;
+        switch (node.op) {
+        case ExprOp::Var:
+            return variable_bits.at(node.var_id);
+        case ExprOp::Const: {
+            if (!node.has_value)
+                return constant_vector(
+                    parse_constant_bits(graph.literal(node.literal_id)),
+                    width);
+            BitVector bits(width, builder.constant(false));
+            for (int i = 0; i < width && i < 64; ++i)
+                bits[i] = builder.constant((node.value >> i) & 1);
+            return bits;
+        }
+        case ExprOp::BitNeg: {
+            BitVector bits = operand(node, 0, width);
+            for (Literal &bit : bits)
+                bit = builder.negate(bit);
+            return bits;
+        }
+        case ExprOp::Minus:
+            return subtract(BitVector(width, builder.constant(false)),
+                            operand(node, 0, width));
+        case ExprOp::LogNeg:
+            return {builder.negate(operand_is_true(node, 0))};
+        case ExprOp::LogAnd:
+            return {builder.create_and(operand_is_true(node, 0),
+                                       operand_is_true(node, 1))};
+        case ExprOp::LogOr:
+            return {builder.create_or(operand_is_true(node, 0),
+                                      operand_is_true(node, 1))};
+        case ExprOp::Eq:
+        case ExprOp::Neq:
+        case ExprOp::Lt:
+        case ExprOp::Le: {
+            int compare_width =
+                std::max(graph.node(node.operands[0]).width,
+                         graph.node(node.operands[1]).width);
+            BitVector lhs = operand(node, 0, compare_width);
+            BitVector rhs = operand(node, 1, compare_width);
+            if (node.op == ExprOp::Eq)
+                return {equal(lhs, rhs)};
+            if (node.op == ExprOp::Neq)
+                return {builder.negate(equal(lhs, rhs))};
+            if (node.op == ExprOp::Lt)
+                return {less_than(lhs, rhs)};
+            return {builder.negate(less_than(rhs, lhs))};
+        }
+        case ExprOp::Shl:
+        case ExprOp::Shr:
+            return shift(operand(node, 0, width), blast(node.operands[1]),
+                         node.op == ExprOp::Shl);
+        case ExprOp::Tern: {
+            Literal predicate = operand_is_true(node, 0);
+            BitVector then_bits = operand(node, 1, width);
+            BitVector else_bits = operand(node, 2, width);
+            for (int i = 0; i < width; ++i)
+                then_bits[i] =
+                    builder.create_mux(predicate, then_bits[i], else_bits[i]);
+            return then_bits;
+        }
+        default:
+            break;
+        }
+        BitVector lhs = operand(node, 0, width);
+        BitVector rhs = operand(node, 1, width);
+        if (node.op == ExprOp::Add)
+            return add(lhs, rhs, builder.constant(false));
+        if (node.op == ExprOp::Sub)
+            return subtract(lhs, rhs);
+        if (node.op == ExprOp::Mul)
+            return multiply(lhs, rhs);
+        if (node.op == ExprOp::Div || node.op == ExprOp::Mod) {
+            BitVector quotient, remainder;
+            divide(lhs, rhs, quotient, remainder);
+            return node.op == ExprOp::Div ? quotient : remainder;
+        }
+        BitVector result(width);
+        for (int i = 0; i < width; ++i) {
+            if (node.op == ExprOp::BitAnd)
+                result[i] = builder.create_and(lhs[i], rhs[i]);
+            else if (node.op == ExprOp::BitOr)
+                result[i] = builder.create_or(lhs[i], rhs[i]);
+            else
+                result[i] = builder.create_xor(lhs[i], rhs[i]);
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,1237 @@
+#ifndef EXPRESSION_GRAPH_H
+#define EXPRESSION_GRAPH_H
+
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+inline std::vector<bool>
+parse_constant_bits(const std::string &verilog_constant) {
+    std::vector<bool> bits;
+    size_t prime_pos = verilog_constant.find('\'');
+    if (prime_pos == std::string::npos) {
+        unsigned long long value = std::stoull(verilog_constant);
+        for (int i = 0; i < 32; ++i)
+            bits.push_back((value >> i) & 1ULL);
+        return bits;
+    }
+    int bit_width = std::stoi(verilog_constant.substr(0, prime_pos));
+    if (bit_width <= 0)
+        throw std::runtime_error("Invalid constant width: " + verilog_constant);
+    char radix = std::tolower(verilog_constant.at(prime_pos + 1));
+    std::string digits = verilog_constant.substr(prime_pos + 2);
+    digits.erase(std::remove(digits.begin(), digits.end(), '_'), digits.end());
+    if (radix == 'd') {
+        unsigned long long value = std::stoull(digits);
+        for (int i = 0; i < bit_width; ++i)
+            bits.push_back(i < 64 && ((value >> i) & 1ULL));
+        return bits;
+    }
+    int bits_per_digit = (radix == 'h') ? 4 : (radix == 'o') ? 3 : 1;
+    if (radix != 'h' && radix != 'o' && radix != 'b')
+        throw std::runtime_error("Unsupported constant: " + verilog_constant);
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+        int digit_value = std::stoi(std::string(1, *it), nullptr,
+                                    1 << bits_per_digit);
+        for (int k = 0; k < bits_per_digit; ++k)
+            bits.push_back((digit_value >> k) & 1);
+    }
+    bits.resize(bit_width, false);
+    return bits;
+}
+
+enum class ExprOp {
+    Var,
+    Const,
+    BitNeg,
+    LogNeg,
+    Minus,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Shl,
+    Shr,
+    BitAnd,
+    BitOr,
+    BitXor,
+    LogAnd,
+    LogOr,
+    Eq,
+    Neq,
+    Lt,
+    Le,
+    Tern
+};
+
+struct ExprOperands {
+    int ids[3] = {-1, -1, -1};
+    int count = 0;
+
+    ExprOperands() = default;
+
+    ExprOperands(std::initializer_list<int> operand_ids) {
+        for (int id : operand_ids)
+            push_back(id);
+    }
+
+    void push_back(int id) { ids[count++] = id; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int &operator[](int k) { return ids[k]; }
+    int operator[](int k) const { return ids[k]; }
+    const int *begin() const { return ids; }
+    const int *end() const { return ids + count; }
+};
+
+struct ExprNode {
+    ExprOp op;
+    int width = 1;
+    ExprOperands operands;
+    int var_id = -1;
+    bool has_value = false;
+    uint64_t value = 0;
+    int literal_id = -1;
+
+    bool operator==(const ExprNode &other) const {
+        return op == other.op && width == other.width &&
+               operands.count == other.operands.count &&
+               std::equal(operands.begin(), operands.end(),
+                          other.operands.begin()) &&
+               var_id == other.var_id && has_value == other.has_value &&
+               value == other.value && literal_id == other.literal_id;
+    }
+};
+
+struct ExprNodeHash {
+    size_t operator()(const ExprNode &node) const {
+        uint64_t hash = static_cast<uint64_t>(node.op) * 0x9e3779b97f4a7c15ULL;
+        auto mix = [&hash](uint64_t field) {
+            hash = (hash ^ field) * 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 32;
+        };
+        mix(static_cast<uint64_t>(node.width));
+        for (int operand : node.operands)
+            mix(static_cast<uint64_t>(operand));
+        mix(static_cast<uint64_t>(node.var_id));
+        mix(node.value);
+        mix(static_cast<uint64_t>(node.literal_id));
+        return static_cast<size_t>(hash);
+    }
+};
+
+inline uint64_t get_width_mask(int width) {
+    return width >= 64 ? ~0ULL : (1ULL << width) - 1;
+}
+
+inline int get_bit_length(uint64_t value) {
+    int bit_length = 1;
+    while (bit_length < 64 && (value >> bit_length) != 0)
+        ++bit_length;
+    return bit_length;
+}
+
+inline bool is_power_of_two(uint64_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+inline bool is_context_sized_binary(const std::string &type) {
+    return type == "ADD" || type == "SUB" || type == "MUL" || type == "DIV" ||
+           type == "MOD" || type == "BIT_AND" || type == "BIT_OR" ||
+           type == "BIT_XOR";
+}
+
+inline bool is_comparison(const std::string &type) {
+    return type == "EQ" || type == "NEQ" || type == "LT" || type == "LE" ||
+           type == "LTE" || type == "GT" || type == "GE" || type == "GTE";
+}
+
+inline ExprOp get_binary_operator(const std::string &type) {
+    if (type == "ADD")
+        return ExprOp::Add;
+    if (type == "SUB")
+        return ExprOp::Sub;
+    if (type == "MUL")
+        return ExprOp::Mul;
+    if (type == "DIV")
+        return ExprOp::Div;
+    if (type == "MOD")
+        return ExprOp::Mod;
+    if (type == "BIT_AND")
+        return ExprOp::BitAnd;
+    if (type == "BIT_OR")
+        return ExprOp::BitOr;
+    return ExprOp::BitXor;
+}
+
+inline bool is_commutative(ExprOp op) {
+    return op == ExprOp::Add || op == ExprOp::Mul || op == ExprOp::BitAnd ||
+           op == ExprOp::BitOr || op == ExprOp::BitXor ||
+           op == ExprOp::LogAnd || op == ExprOp::LogOr || op == ExprOp::Eq ||
+           op == ExprOp::Neq;
+}
+
+inline bool evaluate_operator(ExprOp op, int width, const uint64_t *values,
+                              uint64_t &result) {
+    uint64_t mask = get_width_mask(width);
+    uint64_t lhs = values[0];
+    uint64_t rhs = values[1];
+    switch (op) {
+    case ExprOp::BitNeg:
+        result = ~lhs & mask;
+        return true;
+    case ExprOp::LogNeg:
+        result = lhs == 0;
+        return true;
+    case ExprOp::Minus:
+        result = (0 - lhs) & mask;
+        return true;
+    case ExprOp::Add:
+        result = (lhs + rhs) & mask;
+        return true;
+    case ExprOp::Sub:
+        result = (lhs - rhs) & mask;
+        return true;
+    case ExprOp::Mul:
+        result = (lhs * rhs) & mask;
+        return true;
+    case ExprOp::Div:
+        if (rhs == 0)
+            return false;
+        result = lhs / rhs;
+        return true;
+    case ExprOp::Mod:
+        if (rhs == 0)
+            return false;
+        result = lhs % rhs;
+        return true;
+    case ExprOp::Shl:
+        result = rhs >= static_cast<uint64_t>(width) ? 0 : (lhs << rhs) & mask;
+        return true;
+    case ExprOp::Shr:
+        result = rhs >= static_cast<uint64_t>(width) ? 0 : lhs >> rhs;
+        return true;
+    case ExprOp::BitAnd:
+        result = lhs & rhs;
+        return true;
+    case ExprOp::BitOr:
+        result = lhs | rhs;
+        return true;
+    case ExprOp::BitXor:
+        result = lhs ^ rhs;
+        return true;
+    case ExprOp::LogAnd:
+        result = lhs != 0 && rhs != 0;
+        return true;
+    case ExprOp::LogOr:
+        result = lhs != 0 || rhs != 0;
+        return true;
+    case ExprOp::Eq:
+        result = lhs == rhs;
+        return true;
+    case ExprOp::Neq:
+        result = lhs != rhs;
+        return true;
+    case ExprOp::Lt:
+        result = lhs < rhs;
+        return true;
+    case ExprOp::Le:
+        result = lhs <= rhs;
+        return true;
+    case ExprOp::Tern:
+        result = lhs != 0 ? rhs : values[2];
+        return true;
+    default:
+        return false;
+    }
+}
+
+class ExpressionGraph {
+  public:
+    explicit ExpressionGraph(const nlohmann::json &variable_list) {
+        for (size_t i = 0; i < variable_list.size(); ++i)
+            variable_widths[variable_list[i].value("id", static_cast<int>(i))] =
+                variable_list[i].value("bit_width", 1);
+    }
+
+    const ExprNode &node(int id) const { return nodes[id]; }
+
+    int size() const { return static_cast<int>(nodes.size()); }
+
+    bool get_constant(int id, uint64_t &value) const {
+        if (nodes[id].op != ExprOp::Const || !nodes[id].has_value)
+            return false;
+        value = nodes[id].value;
+        return true;
+    }
+
+    int lower_constraint(const nlohmann::json &node) {
+        return lower(node, self_width(node));
+    }
+
+    const std::vector<int> &get_divisor_guards() const {
+        return divisor_guards;
+    }
+
+    const std::string &literal(int literal_id) const {
+        return literals[literal_id];
+    }
+
+    void collect_variable_ids(int root, std::vector<int> &ids) {
+        visit_marks.resize(nodes.size(), 0);
+        ++visit_epoch;
+        std::vector<int> stack = {root};
+        visit_marks[root] = visit_epoch;
+        while (!stack.empty()) {
+            const ExprNode &current = nodes[stack.back()];
+            stack.pop_back();
+            if (current.op == ExprOp::Var)
+                ids.push_back(current.var_id);
+            for (int operand : current.operands)
+                if (visit_marks[operand] != visit_epoch) {
+                    visit_marks[operand] = visit_epoch;
+                    stack.push_back(operand);
+                }
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    int variable(int var_id) {
+        ExprNode node;
+        node.op = ExprOp::Var;
+        node.width = variable_widths.at(var_id);
+        node.var_id = var_id;
+        return intern(node);
+    }
+
+    int constant(uint64_t value, int width) {
+        ExprNode node;
+        node.op = ExprOp::Const;
+        node.width = width;
+        node.has_value = true;
+        node.value = value & get_width_mask(width);
+        return intern(node);
+    }
+
+    int make(ExprOp op, int width, ExprOperands operands) {
+        uint64_t values[3] = {0, 0, 0};
+        bool all_constant = width <= 64;
+        for (int k = 0; k < operands.size() && all_constant; ++k)
+            all_constant = get_constant(operands[k], values[k]);
+        uint64_t result = 0;
+        if (all_constant && evaluate_operator(op, width, values, result))
+            return constant(result, width);
+        if (is_commutative(op) && nodes[operands[0]].op == ExprOp::Const)
+            std::swap(operands[0], operands[1]);
+        int rewritten = rewrite(op, width, operands);
+        if (rewritten >= 0)
+            return rewritten;
+        if (is_commutative(op) && nodes[operands[1]].op != ExprOp::Const &&
+            operands[0] > operands[1])
+            std::swap(operands[0], operands[1]);
+        ExprNode node;
+        node.op = op;
+        node.width = width;
+        node.operands = operands;
+        return intern(node);
+    }
+
+  private:
+    std::vector<ExprNode> nodes;
+    std::unordered_map<ExprNode, int, ExprNodeHash> node_ids;
+    std::vector<std::string> literals;
+    std::unordered_map<std::string, int> literal_ids;
+    std::unordered_map<const nlohmann::json *, int> self_widths;
+    std::map<int, int> variable_widths;
+    std::vector<int> divisor_guards;
+    std::vector<unsigned> visit_marks;
+    unsigned visit_epoch = 0;
+
+    int self_width(const nlohmann::json &node) {
+        auto it = self_widths.find(&node);
+        if (it != self_widths.end())
+            return it->second;
+        const std::string &type = node["op"].get_ref<const std::string &>();
+        int width = 1;
+        if (type == "VAR")
+            width = variable_widths.at(node.value("id", 0));
+        else if (type == "CONST")
+            width = static_cast<int>(
+                parse_constant_bits(node.value("value", "1'b0")).size());
+        else if (type == "BIT_NEG" || type == "MINUS" || type == "LSHIFT" ||
+                 type == "RSHIFT")
+            width = self_width(node["lhs_expression"]);
+        else if (is_context_sized_binary(type) || type == "TERN")
+            width = std::max(self_width(node["lhs_expression"]),
+                             self_width(node["rhs_expression"]));
+        self_widths.emplace(&node, width);
+        return width;
+    }
+
+    int lower_self(const nlohmann::json &node) {
+        return lower(node, self_width(node));
+    }
+
+    int lower(const nlohmann::json &node, int width) {
+        const std::string &type = node["op"].get_ref<const std::string &>();
+        if (type == "VAR")
+            return variable(node.value("id", 0));
+        if (type == "CONST")
+            return constant_literal(node.value("value", "1'b0"));
+        if (type == "BIT_NEG" || type == "MINUS")
+            return make(type == "BIT_NEG" ? ExprOp::BitNeg : ExprOp::Minus,
+                        width, {lower(node["lhs_expression"], width)});
+        if (type == "LOG_NEG")
+            return make(ExprOp::LogNeg, 1,
+                        {lower_self(node["lhs_expression"])});
+        if (type == "LOG_AND" || type == "LOG_OR" || type == "IMPLY") {
+            int lhs = lower_self(node["lhs_expression"]);
+            int rhs = lower_self(node["rhs_expression"]);
+            if (type == "LOG_AND")
+                return make(ExprOp::LogAnd, 1, {lhs, rhs});
+            if (type == "IMPLY")
+                lhs = make(ExprOp::LogNeg, 1, {lhs});
+            return make(ExprOp::LogOr, 1, {lhs, rhs});
+        }
+        if (is_comparison(type)) {
+            int compare_width = std::max(self_width(node["lhs_expression"]),
+                                         self_width(node["rhs_expression"]));
+            int lhs = lower(node["lhs_expression"], compare_width);
+            int rhs = lower(node["rhs_expression"], compare_width);
+            if (type == "EQ")
+                return make(ExprOp::Eq, 1, {lhs, rhs});
+            if (type == "NEQ")
+                return make(ExprOp::Neq, 1, {lhs, rhs});
+            if (type == "LT")
+                return make(ExprOp::Lt, 1, {lhs, rhs});
+            if (type == "GT")
+                return make(ExprOp::Lt, 1, {rhs, lhs});
+            if (type == "LE" || type == "LTE")
+                return make(ExprOp::Le, 1, {lhs, rhs});
+            return make(ExprOp::Le, 1, {rhs, lhs});
+        }
+        if (type == "LSHIFT" || type == "RSHIFT")
+            return make(type == "LSHIFT" ? ExprOp::Shl : ExprOp::Shr, width,
+                        {lower(node["lhs_expression"], width),
+                         lower_self(node["rhs_expression"])});
+        if (type == "TERN")
+            return make(ExprOp::Tern, width,
+                        {lower_self(node["pred_expression"]),
+                         lower(node["lhs_expression"], width),
+                         lower(node["rhs_expression"], width)});
+        if (!is_context_sized_binary(type))
+            throw std::runtime_error("Unhandled operator: " + type);
+        ExprOp op = get_binary_operator(type);
+        int lhs = lower(node["lhs_expression"], width);
+        int rhs = lower(node["rhs_expression"], width);
+        uint64_t divisor = 0;
+        if ((op == ExprOp::Div || op == ExprOp::Mod) &&
+            (!get_constant(rhs, divisor) || divisor == 0) &&
+            std::find(divisor_guards.begin(), divisor_guards.end(), rhs) ==
+                divisor_guards.end())
+            divisor_guards.push_back(rhs);
+        return make(op, width, {lhs, rhs});
+    }
+
+    int intern(const ExprNode &node) {
+        auto inserted = node_ids.emplace(node, size());
+        if (inserted.second)
+            nodes.push_back(node);
+        return inserted.first->second;
+    }
+
+    int constant_literal(const std::string &verilog_constant) {
+        std::vector<bool> bits = parse_constant_bits(verilog_constant);
+        uint64_t value = 0;
+        for (size_t k = 0; k < bits.size(); ++k) {
+            if (!bits[k])
+                continue;
+            if (k >= 64) {
+                ExprNode node;
+                node.op = ExprOp::Const;
+                node.width = static_cast<int>(bits.size());
+                auto inserted = literal_ids.emplace(
+                    verilog_constant, static_cast<int>(literals.size()));
+                if (inserted.second)
+                    literals.push_back(verilog_constant);
+                node.literal_id = inserted.first->second;
+                return intern(node);
+            }
+            value |= 1ULL << k;
+        }
+        return constant(value, static_cast<int>(bits.size()));
+    }
+
+    int to_bool(int id) {
+        if (nodes[id].width == 1)
+            return id;
+        return make(ExprOp::Neq, 1, {id, constant(0, 1)});
+    }
+
+    int rewrite(ExprOp op, int width, const ExprOperands &operands) {
+        int lhs = operands[0];
+        int rhs = operands.size() > 1 ? operands[1] : -1;
+        ExprNode lhs_node = nodes[lhs];
+        uint64_t lhs_value = 0, rhs_value = 0;
+        bool lhs_constant = get_constant(lhs, lhs_value);
+        bool rhs_constant = rhs >= 0 && get_constant(rhs, rhs_value);
+        bool rhs_all_ones = rhs_constant && width <= 64 &&
+                            rhs_value == get_width_mask(width);
+        switch (op) {
+        case ExprOp::BitNeg:
+        case ExprOp::Minus:
+            if (lhs_node.op == op && lhs_node.width == width)
+                return lhs_node.operands[0];
+            break;
+        case ExprOp::LogNeg:
+            if (lhs_node.op == ExprOp::LogNeg)
+                return to_bool(lhs_node.operands[0]);
+            if (lhs_node.op == ExprOp::Eq || lhs_node.op == ExprOp::Neq)
+                return make(lhs_node.op == ExprOp::Eq ? ExprOp::Neq
+                                                      : ExprOp::Eq,
+                            1, lhs_node.operands);
+            if (lhs_node.op == ExprOp::Lt || lhs_node.op == ExprOp::Le)
+                return make(lhs_node.op == ExprOp::Lt ? ExprOp::Le
+                                                      : ExprOp::Lt,
+                            1, {lhs_node.operands[1], lhs_node.operands[0]});
+            break;
+        case ExprOp::Add:
+        case ExprOp::BitOr:
+            if (rhs_constant && rhs_value == 0)
+                return lhs;
+            if (op == ExprOp::BitOr && (lhs == rhs || rhs_all_ones))
+                return lhs == rhs ? lhs : rhs;
+            break;
+        case ExprOp::Sub:
+            if (rhs_constant && rhs_value == 0)
+                return lhs;
+            if (lhs == rhs)
+                return constant(0, width);
+            break;
+        case ExprOp::Mul:
+            if (rhs_constant && rhs_value == 0)
+                return constant(0, width);
+            if (rhs_constant && is_power_of_two(rhs_value))
+                return make(ExprOp::Shl, width,
+                            {lhs, shift_amount(rhs_value)});
+            break;
+        case ExprOp::Div:
+            if ((lhs_constant && lhs_value == 0) ||
+                (rhs_constant && rhs_value == 0))
+                return constant(0, width);
+            if (lhs == rhs)
+                return constant(1, width);
+            if (rhs_constant && is_power_of_two(rhs_value))
+                return make(ExprOp::Shr, width,
+                            {lhs, shift_amount(rhs_value)});
+            break;
+        case ExprOp::Mod:
+            if ((lhs_constant && lhs_value == 0) || lhs == rhs ||
+                (rhs_constant && rhs_value <= 1))
+                return constant(0, width);
+            if (rhs_constant && is_power_of_two(rhs_value))
+                return make(ExprOp::BitAnd, width,
+                            {lhs, constant(rhs_value - 1, width)});
+            break;
+        case ExprOp::Shl:
+        case ExprOp::Shr:
+            if (rhs_constant && rhs_value == 0)
+                return lhs;
+            if ((lhs_constant && lhs_value == 0) ||
+                (rhs_constant && rhs_value >= static_cast<uint64_t>(width)))
+                return constant(0, width);
+            break;
+        case ExprOp::BitAnd:
+            if (rhs_constant && rhs_value == 0)
+                return constant(0, width);
+            if (lhs == rhs || rhs_all_ones)
+                return lhs;
+            break;
+        case ExprOp::BitXor:
+            if (rhs_constant && rhs_value == 0)
+                return lhs;
+            if (lhs == rhs)
+                return constant(0, width);
+            if (rhs_all_ones)
+                return make(ExprOp::BitNeg, width, {lhs});
+            break;
+        case ExprOp::LogAnd:
+        case ExprOp::LogOr:
+            if (rhs_constant && (rhs_value != 0) == (op == ExprOp::LogOr))
+                return constant(op == ExprOp::LogOr, 1);
+            if (rhs_constant || lhs == rhs)
+                return to_bool(lhs);
+            break;
+        case ExprOp::Eq:
+        case ExprOp::Le:
+            if (lhs == rhs || (op == ExprOp::Le && lhs_constant &&
+                               lhs_value == 0))
+                return constant(1, 1);
+            break;
+        case ExprOp::Neq:
+            if (lhs == rhs)
+                return constant(0, 1);
+            if (rhs_constant && rhs_value == 0 && lhs_node.width == 1)
+                return lhs;
+            break;
+        case ExprOp::Lt:
+            if (lhs == rhs || (rhs_constant && rhs_value == 0))
+                return constant(0, 1);
+            break;
+        case ExprOp::Tern:
+            if (lhs_constant)
+                return lhs_value != 0 ? operands[1] : operands[2];
+            if (operands[1] == operands[2])
+                return operands[1];
+            break;
+        default:
+            break;
+        }
+        return -1;
+    }
+
+    int shift_amount(uint64_t power_of_two) {
+        int amount = 0;
+        while ((power_of_two >> amount) != 1)
+            ++amount;
+        return constant(amount, get_bit_length(amount));
+    }
+};
+
+struct AbstractValue {
+    bool tracked = false;
+    uint64_t known_zero = 0;
+    uint64_t known_one = 0;
+    uint64_t min = 0;
+    uint64_t max = ~0ULL;
+};
+
+const int MAX_RANGE_ITERATIONS = 64;
+
+inline AbstractValue get_top_value(int width) {
+    AbstractValue value;
+    value.tracked = width <= 64;
+    if (value.tracked) {
+        value.known_zero = ~get_width_mask(width);
+        value.max = get_width_mask(width);
+    }
+    return value;
+}
+
+inline AbstractValue get_exact_value(uint64_t constant, int width) {
+    AbstractValue value;
+    value.tracked = true;
+    value.known_one = constant & get_width_mask(width);
+    value.known_zero = ~value.known_one;
+    value.min = value.max = value.known_one;
+    return value;
+}
+
+inline AbstractValue get_bool_value(bool can_be_false, bool can_be_true) {
+    if (!can_be_false)
+        return get_exact_value(1, 1);
+    if (!can_be_true)
+        return get_exact_value(0, 1);
+    return get_top_value(1);
+}
+
+inline AbstractValue get_interval_value(uint64_t min, uint64_t max,
+                                        int width) {
+    AbstractValue value = get_top_value(width);
+    value.min = min;
+    value.max = max;
+    return value;
+}
+
+inline bool is_exact(const AbstractValue &value) {
+    return value.tracked && value.min == value.max;
+}
+
+inline bool is_known_zero(const AbstractValue &value) {
+    return value.tracked && value.max == 0;
+}
+
+inline bool is_known_nonzero(const AbstractValue &value) {
+    return value.tracked && value.min > 0;
+}
+
+inline bool normalize(AbstractValue &value, int width) {
+    if (!value.tracked)
+        return true;
+    uint64_t mask = get_width_mask(width);
+    if (value.known_one & ~mask)
+        return false;
+    value.known_zero |= ~mask;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (value.known_zero & value.known_one)
+            return false;
+        value.min = std::max(value.min, value.known_one);
+        value.max = std::min(value.max, ~value.known_zero);
+        if (value.min > value.max)
+            return false;
+        uint64_t differing = value.min ^ value.max;
+        uint64_t prefix =
+            differing == 0 ? ~0ULL
+                           : ~((2ULL << (63 - __builtin_clzll(differing))) - 1);
+        value.known_one |= value.min & prefix;
+        value.known_zero |= ~value.min & prefix;
+    }
+    return true;
+}
+
+inline bool meet(AbstractValue &value, const AbstractValue &requirement,
+                 int width) {
+    if (!requirement.tracked || width > 64)
+        return true;
+    if (!value.tracked)
+        value = get_top_value(width);
+    value.known_zero |= requirement.known_zero;
+    value.known_one |= requirement.known_one;
+    value.min = std::max(value.min, requirement.min);
+    value.max = std::min(value.max, requirement.max);
+    return normalize(value, width);
+}
+
+inline AbstractValue join(const AbstractValue &lhs, const AbstractValue &rhs) {
+    AbstractValue value;
+    value.tracked = lhs.tracked && rhs.tracked;
+    value.known_zero = lhs.known_zero & rhs.known_zero;
+    value.known_one = lhs.known_one & rhs.known_one;
+    value.min = std::min(lhs.min, rhs.min);
+    value.max = std::max(lhs.max, rhs.max);
+    return value;
+}
+
+inline int count_trailing_zeros(const AbstractValue &value, int width) {
+    int count = 0;
+    while (count < width && ((value.known_zero >> count) & 1))
+        ++count;
+    return count;
+}
+
+inline AbstractValue add_known_bits(const AbstractValue &lhs,
+                                    const AbstractValue &rhs, int width,
+                                    bool subtract) {
+    AbstractValue value = get_top_value(width);
+    int carry = subtract ? 1 : 0;
+    for (int k = 0; k < width; ++k) {
+        uint64_t bit = 1ULL << k;
+        if (!((lhs.known_zero | lhs.known_one) & bit) ||
+            !((rhs.known_zero | rhs.known_one) & bit))
+            break;
+        int sum = ((lhs.known_one & bit) != 0) +
+                  (((rhs.known_one & bit) != 0) ^ subtract) + carry;
+        if (sum & 1)
+            value.known_one |= bit;
+        else
+            value.known_zero |= bit;
+        carry = sum >> 1;
+    }
+    return value;
+}
+
+inline AbstractValue evaluate_abstract(const ExprNode &node,
+                                       const std::vector<AbstractValue> &ops,
+                                       const AbstractValue &variable_domain) {
+    int width = node.width;
+    uint64_t mask = get_width_mask(width);
+    if (node.op == ExprOp::Var)
+        return variable_domain;
+    if (node.op == ExprOp::Const)
+        return node.has_value ? get_exact_value(node.value, width)
+                              : get_top_value(width);
+    for (const AbstractValue &operand : ops)
+        if (!operand.tracked)
+            return get_top_value(width);
+    if (width > 64)
+        return get_top_value(width);
+    const AbstractValue &lhs = ops[0];
+    const AbstractValue &rhs = ops.size() > 1 ? ops[1] : ops[0];
+    AbstractValue value = get_top_value(width);
+    switch (node.op) {
+    case ExprOp::BitNeg:
+        value.known_one = lhs.known_zero & mask;
+        value.known_zero = lhs.known_one | ~mask;
+        value.min = mask - lhs.max;
+        value.max = mask - lhs.min;
+        break;
+    case ExprOp::Minus:
+        if (lhs.min > 0) {
+            value.min = (0 - lhs.max) & mask;
+            value.max = (0 - lhs.min) & mask;
+        } else if (lhs.max == 0)
+            return get_exact_value(0, width);
+        value.known_zero |= get_width_mask(count_trailing_zeros(lhs, width));
+        break;
+    case ExprOp::Add:
+        value = add_known_bits(lhs, rhs, width, false);
+        if (lhs.max <= mask - rhs.max) {
+            value.min = lhs.min + rhs.min;
+            value.max = lhs.max + rhs.max;
+        }
+        break;
+    case ExprOp::Sub:
+        value = add_known_bits(lhs, rhs, width, true);
+        if (lhs.min >= rhs.max || lhs.max < rhs.min) {
+            value.min = (lhs.min - rhs.max) & mask;
+            value.max = (lhs.max - rhs.min) & mask;
+        }
+        break;
+    case ExprOp::Mul: {
+        int trailing_zeros = count_trailing_zeros(lhs, width) +
+                             count_trailing_zeros(rhs, width);
+        value.known_zero |= get_width_mask(std::min(width, trailing_zeros));
+        if (lhs.max == 0 || rhs.max <= mask / lhs.max) {
+            value.min = lhs.min * rhs.min;
+            value.max = lhs.max * rhs.max;
+        }
+        break;
+    }
+    case ExprOp::Div:
+        value.max = rhs.min > 0 ? lhs.max / rhs.min : lhs.max;
+        value.min = rhs.min > 0 ? lhs.min / rhs.max : 0;
+        break;
+    case ExprOp::Mod:
+        if (rhs.min > 0 && lhs.max < rhs.min)
+            return lhs;
+        value.max = rhs.max > 0 ? std::min(lhs.max, rhs.max - 1) : lhs.max;
+        break;
+    case ExprOp::Shl:
+    case ExprOp::Shr:
+        if (rhs.min >= static_cast<uint64_t>(width))
+            return get_exact_value(0, width);
+        if (is_exact(rhs) && node.op == ExprOp::Shl) {
+            int amount = static_cast<int>(rhs.min);
+            value.known_one = (lhs.known_one << amount) & mask;
+            value.known_zero = (lhs.known_zero << amount) | ~mask |
+                               get_width_mask(amount);
+            if (lhs.max <= (mask >> amount)) {
+                value.min = lhs.min << amount;
+                value.max = lhs.max << amount;
+            }
+        } else if (is_exact(rhs)) {
+            int amount = static_cast<int>(rhs.min);
+            value.known_one = lhs.known_one >> amount;
+            value.known_zero = (lhs.known_zero >> amount) | ~(mask >> amount);
+            value.min = lhs.min >> amount;
+            value.max = lhs.max >> amount;
+        } else if (node.op == ExprOp::Shr) {
+            value.max = lhs.max >> rhs.min;
+            if (rhs.max < static_cast<uint64_t>(width))
+                value.min = lhs.min >> rhs.max;
+        }
+        break;
+    case ExprOp::BitAnd:
+        value.known_one = lhs.known_one & rhs.known_one;
+        value.known_zero = lhs.known_zero | rhs.known_zero;
+        value.max = std::min(lhs.max, rhs.max);
+        break;
+    case ExprOp::BitOr:
+        value.known_one = lhs.known_one | rhs.known_one;
+        value.known_zero = lhs.known_zero & rhs.known_zero;
+        value.min = std::max(lhs.min, rhs.min);
+        break;
+    case ExprOp::BitXor:
+        value.known_one = (lhs.known_one & rhs.known_zero) |
+                          (lhs.known_zero & rhs.known_one);
+        value.known_zero = (lhs.known_zero & rhs.known_zero) |
+                           (lhs.known_one & rhs.known_one);
+        break;
+    case ExprOp::LogNeg:
+        return get_bool_value(!is_known_zero(lhs), !is_known_nonzero(lhs));
+    case ExprOp::LogAnd:
+        return get_bool_value(!is_known_nonzero(lhs) ||
+                                  !is_known_nonzero(rhs),
+                              !is_known_zero(lhs) && !is_known_zero(rhs));
+    case ExprOp::LogOr:
+        return get_bool_value(!is_known_nonzero(lhs) &&
+                                  !is_known_nonzero(rhs),
+                              !is_known_zero(lhs) || !is_known_zero(rhs));
+    case ExprOp::Eq:
+    case ExprOp::Neq: {
+        bool can_differ = !(is_exact(lhs) && is_exact(rhs) &&
+                            lhs.min == rhs.min);
+        bool can_equal = lhs.min <= rhs.max && rhs.min <= lhs.max &&
+                         !(lhs.known_one & rhs.known_zero) &&
+                         !(lhs.known_zero & rhs.known_one);
+        if (node.op == ExprOp::Eq)
+            return get_bool_value(can_differ, can_equal);
+        return get_bool_value(can_equal, can_differ);
+    }
+    case ExprOp::Lt:
+        return get_bool_value(lhs.max >= rhs.min, lhs.min < rhs.max);
+    case ExprOp::Le:
+        return get_bool_value(lhs.max > rhs.min, lhs.min <= rhs.max);
+    case ExprOp::Tern:
+        if (is_known_nonzero(lhs))
+            return ops[1];
+        if (is_known_zero(lhs))
+            return ops[2];
+        return join(ops[1], ops[2]);
+    default:
+        break;
+    }
+    if (!normalize(value, width))
+        return get_top_value(width);
+    return value;
+}
+
+class RangeAnalysis {
+  public:
+    explicit RangeAnalysis(ExpressionGraph &expression_graph)
+        : graph(expression_graph) {}
+
+    bool run(const std::vector<int> &roots) {
+        for (int iteration = 0; iteration < MAX_RANGE_ITERATIONS;
+             ++iteration) {
+            propagate_forward();
+            bool changed = false;
+            if (!propagate_backward(roots, changed))
+                return false;
+            if (!changed)
+                break;
+        }
+        propagate_forward();
+        return true;
+    }
+
+    std::vector<int> simplify(const std::vector<int> &roots) {
+        int num_nodes = static_cast<int>(values.size());
+        std::vector<int> simplified(num_nodes);
+        for (int id = 0; id < num_nodes; ++id) {
+            const ExprNode node = graph.node(id);
+            if (is_exact(values[id]))
+                simplified[id] = graph.constant(values[id].min, node.width);
+            else if (node.op == ExprOp::Var)
+                simplified[id] = get_forced_variable(id);
+            else if (node.op == ExprOp::Const)
+                simplified[id] = id;
+            else {
+                ExprOperands operands;
+                for (int operand : node.operands)
+                    operands.push_back(simplified[operand]);
+                simplified[id] = graph.make(node.op, node.width, operands);
+            }
+        }
+        std::vector<int> simplified_roots;
+        for (int root : roots)
+            simplified_roots.push_back(simplified[root]);
+        for (const auto &entry : variable_domains) {
+            int fact = get_domain_fact(entry.first, entry.second);
+            if (fact >= 0)
+                simplified_roots.push_back(fact);
+        }
+        return simplified_roots;
+    }
+
+  private:
+    ExpressionGraph &graph;
+    std::vector<AbstractValue> values;
+    std::map<int, AbstractValue> variable_domains;
+
+    AbstractValue get_variable_domain(int var_id, int width) const {
+        auto it = variable_domains.find(var_id);
+        return it != variable_domains.end() ? it->second
+                                            : get_top_value(width);
+    }
+
+    void propagate_forward() {
+        values.resize(graph.size());
+        std::vector<AbstractValue> operand_values;
+        for (int id = 0; id < graph.size(); ++id) {
+            const ExprNode &node = graph.node(id);
+            operand_values.clear();
+            for (int operand : node.operands)
+                operand_values.push_back(values[operand]);
+            values[id] = evaluate_abstract(
+                node, operand_values,
+                get_variable_domain(node.var_id, node.width));
+        }
+    }
+
+    bool require(std::vector<AbstractValue> &refined,
+                 std::vector<unsigned char> &pending, int id,
+                 const AbstractValue &requirement) {
+        AbstractValue before = refined[id];
+        if (!meet(refined[id], requirement, graph.node(id).width))
+            return false;
+        const AbstractValue &after = refined[id];
+        if (after.known_zero != before.known_zero ||
+            after.known_one != before.known_one || after.min != before.min ||
+            after.max != before.max || after.tracked != before.tracked)
+            pending[id] = 1;
+        return true;
+    }
+
+    bool require_less(std::vector<AbstractValue> &refined,
+                      std::vector<unsigned char> &pending, int lhs, int rhs,
+                      bool strict) {
+        const AbstractValue lhs_value = refined[lhs];
+        const AbstractValue rhs_value = refined[rhs];
+        if (!lhs_value.tracked || !rhs_value.tracked)
+            return true;
+        if (strict && rhs_value.max == 0)
+            return false;
+        uint64_t strict_step = strict ? 1 : 0;
+        if (lhs_value.min > ~0ULL - strict_step)
+            return false;
+        return require(refined, pending, lhs,
+                       get_interval_value(0, rhs_value.max - strict_step,
+                                          graph.node(lhs).width)) &&
+               require(refined, pending, rhs,
+                       get_interval_value(lhs_value.min + strict_step, ~0ULL,
+                                          graph.node(rhs).width));
+    }
+
+    bool exclude_value(std::vector<AbstractValue> &refined,
+                       std::vector<unsigned char> &pending, int id,
+                       const AbstractValue &excluded) {
+        AbstractValue value = refined[id];
+        if (!is_exact(excluded) || !value.tracked)
+            return true;
+        if (value.min == excluded.min && value.min == value.max)
+            return false;
+        if (value.min == excluded.min)
+            ++value.min;
+        else if (value.max == excluded.min)
+            --value.max;
+        return require(refined, pending, id, value);
+    }
+
+    bool propagate_node(std::vector<AbstractValue> &refined,
+                        std::vector<unsigned char> &pending, int id) {
+        const ExprNode &node = graph.node(id);
+        const AbstractValue value = refined[id];
+        int width = node.width;
+        uint64_t mask = get_width_mask(width);
+        if (!value.tracked || node.operands.empty())
+            return true;
+        int lhs = node.operands[0];
+        int rhs = node.operands.size() > 1 ? node.operands[1] : lhs;
+        AbstractValue nonzero = get_interval_value(1, ~0ULL, 64);
+        AbstractValue zero = get_exact_value(0, 64);
+        bool is_true = is_exact(value) && value.min != 0;
+        bool is_false = is_exact(value) && value.min == 0;
+        switch (node.op) {
+        case ExprOp::LogNeg:
+            if (is_true)
+                return require(refined, pending, lhs, zero);
+            if (is_false)
+                return require(refined, pending, lhs, nonzero);
+            break;
+        case ExprOp::LogAnd:
+        case ExprOp::LogOr: {
+            bool all_required = node.op == ExprOp::LogAnd ? is_true : is_false;
+            bool one_required = node.op == ExprOp::LogAnd ? is_false : is_true;
+            const AbstractValue &requirement =
+                node.op == ExprOp::LogAnd ? nonzero : zero;
+            const AbstractValue &other_requirement =
+                node.op == ExprOp::LogAnd ? zero : nonzero;
+            if (all_required)
+                return require(refined, pending, lhs, requirement) &&
+                       require(refined, pending, rhs, requirement);
+            if (one_required && node.op == ExprOp::LogAnd) {
+                if (is_known_nonzero(refined[lhs]))
+                    return require(refined, pending, rhs, other_requirement);
+                if (is_known_nonzero(refined[rhs]))
+                    return require(refined, pending, lhs, other_requirement);
+            } else if (one_required) {
+                if (is_known_zero(refined[lhs]))
+                    return require(refined, pending, rhs, other_requirement);
+                if (is_known_zero(refined[rhs]))
+                    return require(refined, pending, lhs, other_requirement);
+            }
+            break;
+        }
+        case ExprOp::Eq:
+        case ExprOp::Neq:
+            if ((node.op == ExprOp::Eq && is_true) ||
+                (node.op == ExprOp::Neq && is_false)) {
+                const AbstractValue lhs_value = refined[lhs];
+                return require(refined, pending, lhs, refined[rhs]) &&
+                       require(refined, pending, rhs, lhs_value);
+            }
+            if (is_true || is_false)
+                return exclude_value(refined, pending, lhs, refined[rhs]) &&
+                       exclude_value(refined, pending, rhs, refined[lhs]);
+            break;
+        case ExprOp::Lt:
+        case ExprOp::Le:
+            if (is_true)
+                return require_less(refined, pending, lhs, rhs,
+                                    node.op == ExprOp::Lt);
+            if (is_false)
+                return require_less(refined, pending, rhs, lhs,
+                                    node.op == ExprOp::Le);
+            break;
+        case ExprOp::BitNeg: {
+            AbstractValue operand_value = get_top_value(width);
+            operand_value.known_one = value.known_zero & mask;
+            operand_value.known_zero = value.known_one | ~mask;
+            operand_value.min = mask - value.max;
+            operand_value.max = mask - value.min;
+            return require(refined, pending, lhs, operand_value);
+        }
+        case ExprOp::BitAnd:
+        case ExprOp::BitOr: {
+            bool is_and = node.op == ExprOp::BitAnd;
+            for (int k = 0; k < 2; ++k) {
+                int operand = node.operands[k];
+                const AbstractValue &other = refined[node.operands[1 - k]];
+                AbstractValue operand_value = get_top_value(width);
+                if (is_and) {
+                    operand_value.known_one = value.known_one;
+                    operand_value.known_zero |=
+                        value.known_zero & other.known_one;
+                } else {
+                    operand_value.known_zero |= value.known_zero;
+                    operand_value.known_one =
+                        value.known_one & other.known_zero & mask;
+                }
+                if (!require(refined, pending, operand, operand_value))
+                    return false;
+            }
+            break;
+        }
+        case ExprOp::BitXor:
+            for (int k = 0; k < 2; ++k) {
+                const AbstractValue &other = refined[node.operands[1 - k]];
+                if (!is_exact(other))
+                    continue;
+                AbstractValue operand_value = get_top_value(width);
+                operand_value.known_one =
+                    ((value.known_one & ~other.min) |
+                     (value.known_zero & other.min)) &
+                    mask;
+                operand_value.known_zero |=
+                    (value.known_zero & ~other.min) |
+                    (value.known_one & other.min);
+                if (!require(refined, pending, node.operands[k],
+                             operand_value))
+                    return false;
+            }
+            break;
+        case ExprOp::Add:
+        case ExprOp::Sub: {
+            const AbstractValue operand_value = refined[lhs];
+            if (!is_exact(refined[rhs]))
+                break;
+            uint64_t constant = refined[rhs].min;
+            if (node.op == ExprOp::Add &&
+                operand_value.max <= mask - constant) {
+                if (value.max < constant)
+                    return false;
+                return require(refined, pending, lhs,
+                               get_interval_value(
+                                   value.min >= constant ? value.min - constant
+                                                         : 0,
+                                   value.max - constant, width));
+            }
+            if (node.op == ExprOp::Sub && operand_value.min >= constant)
+                return require(refined, pending, lhs,
+                               get_interval_value(value.min + constant,
+                                                  value.max + constant,
+                                                  width));
+            break;
+        }
+        case ExprOp::Tern:
+            if (is_known_nonzero(refined[lhs]))
+                return require(refined, pending, node.operands[1], value);
+            if (is_known_zero(refined[lhs]))
+                return require(refined, pending, node.operands[2], value);
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    bool propagate_backward(const std::vector<int> &roots, bool &changed) {
+        std::vector<AbstractValue> refined = values;
+        std::vector<unsigned char> pending(values.size(), 0);
+        for (int root : roots)
+            if (!require(refined, pending, root,
+                         get_interval_value(1, ~0ULL, 64)))
+                return false;
+        for (int id = static_cast<int>(values.size()) - 1; id >= 0; --id)
+            if (pending[id] && !propagate_node(refined, pending, id))
+                return false;
+        changed = false;
+        for (int id = 0; id < static_cast<int>(values.size()); ++id) {
+            const ExprNode &node = graph.node(id);
+            if (node.op != ExprOp::Var || !pending[id])
+                continue;
+            variable_domains[node.var_id] = refined[id];
+            changed = true;
+        }
+        return true;
+    }
+
+    int get_forced_variable(int id) {
+        const ExprNode node = graph.node(id);
+        const AbstractValue &domain = values[id];
+        uint64_t mask = get_width_mask(node.width);
+        uint64_t known = (domain.known_zero | domain.known_one) & mask;
+        if (!domain.tracked || known == 0)
+            return id;
+        return graph.make(
+            ExprOp::BitOr, node.width,
+            {graph.make(ExprOp::BitAnd, node.width,
+                        {id, graph.constant(~known & mask, node.width)}),
+             graph.constant(domain.known_one, node.width)});
+    }
+
+    int get_domain_fact(int var_id, const AbstractValue &domain) {
+        int variable = graph.variable(var_id);
+        int width = graph.node(variable).width;
+        uint64_t mask = get_width_mask(width);
+        uint64_t known = (domain.known_zero | domain.known_one) & mask;
+        if (is_exact(domain))
+            return graph.make(ExprOp::Eq, 1,
+                              {variable, graph.constant(domain.min, width)});
+        int fact = -1;
+        auto add_fact = [&](int condition) {
+            fact = fact < 0 ? condition
+                            : graph.make(ExprOp::LogAnd, 1, {fact, condition});
+        };
+        if (known != 0)
+            add_fact(graph.make(
+                ExprOp::Eq, 1,
+                {graph.make(ExprOp::BitAnd, width,
+                            {variable, graph.constant(known, width)}),
+                 graph.constant(domain.known_one, width)}));
+        if (domain.min > domain.known_one)
+            add_fact(graph.make(ExprOp::Le, 1,
+                                {graph.constant(domain.min, width), variable}));
+        if (domain.max < (~domain.known_zero & mask))
+            add_fact(graph.make(ExprOp::Le, 1,
+                                {variable, graph.constant(domain.max, width)}));
+        return fact;
+    }
+};
+
+inline std::vector<int>
+lower_constraint_list(ExpressionGraph &graph,
+                      const nlohmann::json &constraint_list) {
+    std::vector<int> roots;
+    for (const auto &cnstr_json_node : constraint_list)
+        roots.push_back(graph.lower_constraint(cnstr_json_node));
+    roots.insert(roots.end(), graph.get_divisor_guards().begin(),
+                 graph.get_divisor_guards().end());
+    RangeAnalysis range_analysis(graph);
+    if (!range_analysis.run(roots))
+        return {graph.constant(0, 1)};
+    return range_analysis.simplify(roots);
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "constraint_bit_blaster.h"
+#include "nlohmann/json.hpp"
+#include "solver_functions.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace std;
+
+class AigBuilder {
+  public:
+    using Literal = int;
+
+    explicit AigBuilder(AigData &aig_data) : data(aig_data) {
+        data.nM = data.nI = data.nL = data.nO = data.nA = 0;
+        data.input_index_by_var.assign(1, -1);
+        data.is_and_var.assign(1, 0);
+        data.and_fanins.assign(2, 0);
+    }
+
+    int constant(bool value) const { return value ? 1 : 0; }
+
+    int negate(int lit) const { return lit ^ 1; }
+
+    int create_input() {
+        int input_var = add_var();
+        data.input_index_by_var[input_var] = data.nI++;
+        data.primary_input_literals.push_back(2 * input_var);
+        return 2 * input_var;
+    }
+
+    int create_and(int lhs_lit, int rhs_lit) {
+        if (lhs_lit > rhs_lit)
+            std::swap(lhs_lit, rhs_lit);
+        if (lhs_lit == 0)
+            return 0;
+        if (lhs_lit == 1 || lhs_lit == rhs_lit)
+            return rhs_lit;
+        if ((lhs_lit ^ 1) == rhs_lit)
+            return 0;
+        uint64_t key = (static_cast<uint64_t>(lhs_lit) << 32) |
+                       static_cast<uint32_t>(rhs_lit);
+        auto it = structural_hash.find(key);
+        if (it != structural_hash.end())
+            return it->second;
+        int output_var = add_var();
+        int output_lit = 2 * output_var;
+        data.nA++;
+        data.is_and_var[output_var] = 1;
+        data.and_fanins[2 * output_var] = lhs_lit;
+        data.and_fanins[2 * output_var + 1] = rhs_lit;
+        data.and_gate_vars.push_back(output_var);
+        structural_hash.emplace(key, output_lit);
+        return output_lit;
+    }
+
+    int create_or(int lhs_lit, int rhs_lit) {
+        return create_and(lhs_lit ^ 1, rhs_lit ^ 1) ^ 1;
+    }
+
+    int create_xor(int lhs_lit, int rhs_lit) {
+        if (lhs_lit > rhs_lit)
+            std::swap(lhs_lit, rhs_lit);
+        if (lhs_lit <= 1)
+            return rhs_lit ^ lhs_lit;
+        if (lhs_lit == rhs_lit)
+            return 0;
+        if ((lhs_lit ^ 1) == rhs_lit)
+            return 1;
+        return create_or(create_and(lhs_lit, rhs_lit ^ 1),
+                         create_and(lhs_lit ^ 1, rhs_lit));
+    }
+
+    int create_mux(int select_lit, int then_lit, int else_lit) {
+        if (then_lit == else_lit)
+            return then_lit;
+        return create_or(create_and(select_lit, then_lit),
+                         create_and(select_lit ^ 1, else_lit));
+    }
+
+    void add_output(int output_lit) {
+        data.circuit_output_literals.push_back(output_lit);
+        data.nO++;
+    }
+
+  private:
+    AigData &data;
+    std::unordered_map<uint64_t, int> structural_hash;
+
+    int add_var() {
+        int var = ++data.nM;
+        data.input_index_by_var.push_back(-1);
+        data.is_and_var.push_back(0);
+        data.and_fanins.push_back(0);
+        data.and_fanins.push_back(0);
+        return var;
+    }
+};
+
+bool compile_json_to_aig(const json &data, AigData &aig_data) {
+    auto compile_start_time = std::chrono::high_resolution_clock::now();
+    if (!data.contains("variable_list") || !data["variable_list"].is_array() ||
+        !data.contains("constraint_list") ||
+        !data["constraint_list"].is_array())
+        return false;
+    try {
+        ExpressionGraph graph(data["variable_list"]);
+        std::vector<int> roots =
+            lower_constraint_list(graph, data["constraint_list"]);
+        AigBuilder builder(aig_data);
+        ConstraintBitBlaster<AigBuilder> blaster(builder, graph,
+                                                 data["variable_list"]);
+        for (int root : roots) {
+            int constraint_lit = blaster.blast_constraint(root);
+            if (constraint_lit != builder.constant(true))
+                builder.add_output(constraint_lit);
+        }
+        if (aig_data.nO == 0)
+            builder.add_output(1);
+    } catch (const std::exception &e) {
+        return false;
+    }
+    auto compile_end_time = std::chrono::high_resolution_clock::now();
+    auto compile_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            compile_end_time - compile_start_time);
+    return true;
+}
+
+std::shared_ptr<CompiledConstraints>
+compile_json_constraints(const json &data, const SolverOptions &options) {
+    AigData aig_data;
+    if (!compile_json_to_aig(data, aig_data))
+        return nullptr;
+    return compile_aig_data(aig_data, data["variable_list"],
+                            get_input_layout(data), options);
+}
+
+int json_aig_solver(const string &input_json_path,
+                    const std::vector<SamplingJob> &jobs,
+                    const SolverOptions &options) {
+    json data;
+    ifstream input_json_stream(input_json_path);
+    if (!input_json_stream.is_open())
+        return 1;
+    try {
+        input_json_stream >> data;
+    } catch (const json::parse_error &e) {
+        input_json_stream.close();
+        return 1;
+    }
+    input_json_stream.close();
+    std::shared_ptr<CompiledConstraints> compiled =
+        load_or_compile_constraints(data, "aig", options, [&] {
+            return compile_json_constraints(data, options);
+        });
+    if (!compiled)
+        return 1;
+    return sample_compiled_jobs(*compiled, jobs, options);
+}
@@ -0,0 +1,345 @@
+#include "constraint_bit_blaster.h"
+#include "cudd.h"
+#include "nlohmann/json.hpp"
+#include "solver_functions.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace std;
+
+class BddBuilder {
+  public:
+    using Literal = DdNode *;
+
+    BddBuilder(DdManager *cudd_manager,
+               const std::vector<DdNode *> &input_vars_bdd)
+        : manager(cudd_manager), input_vars(input_vars_bdd) {}
+
+    ~BddBuilder() { release_intermediate_nodes(); }
+
+    DdNode *constant(bool value) const {
+        return value ? Cudd_ReadOne(manager) : Cudd_ReadLogicZero(manager);
+    }
+
+    DdNode *negate(DdNode *node) const { return Cudd_Not(node); }
+
+    DdNode *create_input() { return input_vars.at(next_input_idx++); }
+
+    DdNode *create_and(DdNode *lhs, DdNode *rhs) {
+        return keep(Cudd_bddAnd(manager, lhs, rhs));
+    }
+
+    DdNode *create_or(DdNode *lhs, DdNode *rhs) {
+        return keep(Cudd_bddOr(manager, lhs, rhs));
+    }
+
+    DdNode *create_xor(DdNode *lhs, DdNode *rhs) {
+        return keep(Cudd_bddXor(manager, lhs, rhs));
+    }
+
+    DdNode *create_mux(DdNode *select, DdNode *then_node, DdNode *else_node) {
+        return keep(Cudd_bddIte(manager, select, then_node, else_node));
+    }
+
+    void release_intermediate_nodes() {
+        for (DdNode *node : intermediate_nodes)
+            Cudd_RecursiveDeref(manager, node);
+        intermediate_nodes.clear();
+    }
+
+  private:
+    DdManager *manager;
+    std::vector<DdNode *> input_vars;
+    size_t next_input_idx = 0;
+    std::vector<DdNode *> intermediate_nodes;
+
+    DdNode *keep(DdNode *node) {
+        if (!node)
+            throw std::runtime_error("CUDD operation failed.");
+        Cudd_Ref(node);
+        intermediate_nodes.push_back(node);
+        return node;
+    }
+};
+
+static bool is_word_level_operator(const std::string &type) {
+    return type == "ADD" || type == "SUB" || type == "MUL" || type == "DIV" ||
+           type == "MOD" || type == "BIT_AND" || type == "BIT_OR" ||
+           type == "BIT_XOR" || type == "EQ" || type == "NEQ" ||
+           type == "LT" || type == "LE" || type == "LTE" || type == "GT" ||
+           type == "GE" || type == "GTE";
+}
+
+static void
+collect_operand_groups(const json &node,
+                       std::vector<std::vector<int>> &operand_groups) {
+    for (const char *child :
+         {"pred_expression", "lhs_expression", "rhs_expression"})
+        if (node.contains(child))
+            collect_operand_groups(node[child], operand_groups);
+    if (!is_word_level_operator(node["op"]))
+        return;
+    std::vector<int> group;
+    collect_variable_ids(node, group);
+    if (group.size() > 1)
+        operand_groups.push_back(group);
+}
+
+static int
+get_variable_bit_ranges(const json &variable_list,
+                        std::map<int, int> &var_id_to_first_bit,
+                        std::map<int, int> &var_id_to_width) {
+    int total_bits = 0;
+    for (size_t i = 0; i < variable_list.size(); ++i) {
+        int id = variable_list[i].value("id", static_cast<int>(i));
+        int bit_width = variable_list[i].value("bit_width", 1);
+        var_id_to_first_bit[id] = total_bits;
+        var_id_to_width[id] = bit_width;
+        total_bits += bit_width;
+    }
+    return total_bits;
+}
+
+static std::vector<int>
+determine_interleaved_bit_order(const json &variable_list,
+                                const json &constraint_list,
+                                const std::vector<int> &constraint_order) {
+    std::map<int, int> var_id_to_first_bit;
+    std::map<int, int> var_id_to_width;
+    int total_bits = get_variable_bit_ranges(variable_list, var_id_to_first_bit,
+                                             var_id_to_width);
+    std::vector<int> bit_order;
+    std::vector<bool> placed(total_bits, false);
+    auto place_interleaved = [&](const std::vector<int> &group) {
+        int max_width = 0;
+        for (int id : group)
+            max_width = std::max(max_width, var_id_to_width.at(id));
+        for (int k = 0; k < max_width; ++k)
+            for (int id : group) {
+                int bit_idx = var_id_to_first_bit.at(id) + k;
+                if (k < var_id_to_width.at(id) && !placed[bit_idx]) {
+                    placed[bit_idx] = true;
+                    bit_order.push_back(bit_idx);
+                }
+            }
+    };
+    for (int constraint_idx : constraint_order) {
+        const json &cnstr_json_node = constraint_list[constraint_idx];
+        std::vector<std::vector<int>> operand_groups;
+        collect_operand_groups(cnstr_json_node, operand_groups);
+        std::vector<int> all_ids;
+        collect_variable_ids(cnstr_json_node, all_ids);
+        operand_groups.push_back(all_ids);
+        for (const auto &group : operand_groups)
+            place_interleaved(group);
+    }
+    for (int bit_idx = 0; bit_idx < total_bits; ++bit_idx)
+        if (!placed[bit_idx])
+            bit_order.push_back(bit_idx);
+    return bit_order;
+}
+
+static std::vector<std::set<int>>
+get_constraint_variable_ids(const json &constraint_list) {
+    std::vector<std::set<int>> constraint_variable_ids;
+    for (const auto &cnstr_json_node : constraint_list) {
+        std::vector<int> ids;
+        collect_variable_ids(cnstr_json_node, ids);
+        constraint_variable_ids.emplace_back(ids.begin(), ids.end());
+    }
+    return constraint_variable_ids;
+}
+
+static std::vector<int> get_component_constraint_order(
+    const std::vector<std::vector<int>> &components) {
+    std::vector<int> constraint_order;
+    for (const auto &component : components)
+        constraint_order.insert(constraint_order.end(), component.begin(),
+                                component.end());
+    return constraint_order;
+}
+
+static std::map<int, int>
+get_word_clusters(const json &variable_list, const json &constraint_list) {
+    std::map<int, int> parent;
+    for (size_t i = 0; i < variable_list.size(); ++i) {
+        int id = variable_list[i].value("id", static_cast<int>(i));
+        parent[id] = id;
+    }
+    std::function<int(int)> find_root = [&](int id) {
+        int &root = parent.at(id);
+        if (root != id)
+            root = find_root(root);
+        return root;
+    };
+    for (const auto &cnstr_json_node : constraint_list) {
+        std::vector<std::vector<int>> operand_groups;
+        collect_operand_groups(cnstr_json_node, operand_groups);
+        for (const auto &group : operand_groups)
+            for (size_t k = 1; k < group.size(); ++k)
+                parent[find_root(group[k])] = find_root(group[0]);
+    }
+    std::map<int, int> word_cluster;
+    for (const auto &entry : parent)
+        word_cluster[entry.first] = find_root(entry.first);
+    return word_cluster;
+}
+
+InputLayout get_input_layout(const json &data) {
+    InputLayout input_layout;
+    if (!data.contains("variable_list") || !data["variable_list"].is_array() ||
+        !data.contains("constraint_list") ||
+        !data["constraint_list"].is_array())
+        return input_layout;
+    const json &variable_list = data["variable_list"];
+    const json &constraint_list = data["constraint_list"];
+    try {
+        std::map<int, int> word_cluster =
+            get_word_clusters(variable_list, constraint_list);
+        for (size_t i = 0; i < variable_list.size(); ++i) {
+            int id = variable_list[i].value("id", static_cast<int>(i));
+            int bit_width = variable_list[i].value("bit_width", 1);
+            for (int k = 0; k < bit_width; ++k)
+                input_layout.input_bits.push_back({id, k, word_cluster[id]});
+        }
+        std::vector<int> constraint_order = get_component_constraint_order(
+            get_constraint_components_by_dsu_strategy(
+                get_constraint_variable_ids(constraint_list)));
+        input_layout.interleaved_bit_order = determine_interleaved_bit_order(
+            variable_list, constraint_list, constraint_order);
+    } catch (const std::exception &e) {
+        return InputLayout();
+    }
+    return input_layout;
+}
+
+static DdNode *
+build_constraint_conjunction(DdManager *manager, const ExpressionGraph &graph,
+                             const json &variable_list,
+                             const std::vector<int> &roots,
+                             const std::vector<DdNode *> &input_vars_bdd,
+                             const std::vector<int> &constraint_order) {
+    BddBuilder builder(manager, input_vars_bdd);
+    ConstraintBitBlaster<BddBuilder> blaster(builder, graph, variable_list);
+    DdNode *conjunction = Cudd_ReadOne(manager);
+    Cudd_Ref(conjunction);
+    for (int constraint_idx : constraint_order) {
+        DdNode *constraint_bdd =
+            blaster.blast_constraint(roots[constraint_idx]);
+        DdNode *next_conjunction =
+            Cudd_bddAnd(manager, conjunction, constraint_bdd);
+        if (!next_conjunction) {
+            Cudd_RecursiveDeref(manager, conjunction);
+            return nullptr;
+        }
+        Cudd_Ref(next_conjunction);
+        Cudd_RecursiveDeref(manager, conjunction);
+        conjunction = next_conjunction;
+        blaster.clear_cache();
+        builder.release_intermediate_nodes();
+        if (conjunction == Cudd_ReadLogicZero(manager))
+            break;
+    }
+    return conjunction;
+}
+
+static std::shared_ptr<CompiledConstraints>
+compile_json_bdd_constraints(const json &data, const SolverOptions &options) {
+    const json &variable_list = data["variable_list"];
+    const json &constraint_list = data["constraint_list"];
+    ExpressionGraph graph(variable_list);
+    std::vector<int> roots;
+    try {
+        roots = lower_constraint_list(graph, constraint_list);
+    } catch (const std::exception &e) {
+        return nullptr;
+    }
+    std::vector<std::set<int>> root_variable_ids;
+    for (int root : roots) {
+        std::vector<int> ids;
+        graph.collect_variable_ids(root, ids);
+        root_variable_ids.emplace_back(ids.begin(), ids.end());
+    }
+    std::vector<std::vector<int>> components =
+        get_constraint_components_by_dsu_strategy(root_variable_ids);
+    InputLayout input_layout = get_input_layout(data);
+    const std::vector<int> &bit_order = input_layout.interleaved_bit_order;
+    if (bit_order.size() != input_layout.input_bits.size())
+        return nullptr;
+    std::map<int, int> var_id_to_first_bit;
+    std::map<int, int> var_id_to_width;
+    get_variable_bit_ranges(variable_list, var_id_to_first_bit,
+                            var_id_to_width);
+    ComponentBuilder build_component = [&](int component_idx,
+                                           DdManager *manager,
+                                           ComponentBdd &component) {
+        std::vector<bool> in_component(bit_order.size(), false);
+        for (int root_idx : components[component_idx])
+            for (int id : root_variable_ids[root_idx])
+                for (int k = 0; k < var_id_to_width.at(id); ++k)
+                    in_component[var_id_to_first_bit.at(id) + k] = true;
+        std::vector<int> component_bits;
+        for (int bit_idx : bit_order)
+            if (in_component[bit_idx])
+                component_bits.push_back(bit_idx);
+        std::vector<std::vector<int>> input_groups = group_input_order(
+            component_bits, input_layout, options.variable_groups);
+        std::vector<DdNode *> input_vars_bdd(bit_order.size(), nullptr);
+        for (const auto &input_group : input_groups)
+            for (int bit_idx : input_group) {
+                input_vars_bdd[bit_idx] = Cudd_bddNewVar(manager);
+                if (!input_vars_bdd[bit_idx])
+                    return false;
+                component.bit_indices.push_back(bit_idx);
+                component.input_vars.push_back(input_vars_bdd[bit_idx]);
+            }
+        if (!register_variable_groups(manager, input_groups))
+            return false;
+        component.output = build_constraint_conjunction(
+            manager, graph, variable_list, roots, input_vars_bdd,
+            components[component_idx]);
+        return component.output != nullptr;
+    };
+    return compile_components(static_cast<int>(components.size()),
+                              build_component, variable_list, options);
+}
+
+int json_bdd_solver(const string &input_json_path,
+                    const std::vector<SamplingJob> &jobs,
+                    const SolverOptions &options) {
+    auto function_start_time = std::chrono::high_resolution_clock::now();
+    json data;
+    ifstream input_json_stream(input_json_path);
+    if (!input_json_stream.is_open())
+        return 1;
+    try {
+        input_json_stream >> data;
+    } catch (const json::parse_error &e) {
+        input_json_stream.close();
+        return 1;
+    }
+    input_json_stream.close();
+    if (!data.contains("variable_list") || !data["variable_list"].is_array() ||
+        !data.contains("constraint_list") ||
+        !data["constraint_list"].is_array())
+        return 1;
+    std::shared_ptr<CompiledConstraints> compiled =
+        load_or_compile_constraints(data, "bdd", options, [&] {
+            return compile_json_bdd_constraints(data, options);
+        });
+    int status = compiled ? sample_compiled_jobs(*compiled, jobs, options) : 1;
+    auto function_end_time = std::chrono::high_resolution_clock::now();
+    auto function_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            function_end_time - function_start_time);
+    return status;
+}
@@ -1,5 +1,7 @@
+#include "expression_graph.h"
 #include "nlohmann/json.hpp"
 #include "solver_functions.h"
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -10,7 +12,8 @@
 #include <numeric>
 #include <algorithm>
 #include <optional>
-#include <climits>
+#include <stdexcept>
+#include <unordered_map>
 
 using json = nlohmann::json;
 using namespace std;
@@ -22,267 +25,193 @@ struct DSUComponentForVerilogOrder {
     int representative_dsu_root_idx;
 };
 
-struct EvaluatedConstant {
-    long long value;
-    int bit_width;
-    bool is_zero;
-    bool is_all_ones;
-    static std::optional<EvaluatedConstant>
-    from_verilog_string(const std::string &s) {
-        EvaluatedConstant ec;
-        ec.is_zero = false;
-        ec.is_all_ones = false;
-        ec.bit_width = -1;
-        try {
-            size_t prime_pos = s.find('\'');
-            if (prime_pos != std::string::npos) {
-                if (prime_pos == 0)
-                    return std::nullopt;
-                ec.bit_width = std::stoi(s.substr(0, prime_pos));
-                if (ec.bit_width <= 0)
-                    return std::nullopt;
-                char type_char = s[prime_pos + 1];
-                std::string val_str = s.substr(prime_pos + 2);
-                if (val_str.empty())
-                    return std::nullopt;
-                unsigned long long num_val = 0;
-                if (type_char == 'b') {
-                    if (val_str.find_first_not_of("01xzXZ") !=
-                            std::string::npos ||
-                        val_str.find_first_of("xzXZ") != std::string::npos)
-                        return std::nullopt;
-                    num_val = std::stoull(val_str, nullptr, 2);
-                } else if (type_char == 'h' || type_char == 'H') {
-                    if (val_str.find_first_not_of(
-                            "0123456789abcdefABCDEFxzXZ") !=
-                            std::string::npos ||
-                        val_str.find_first_of("xzXZ") != std::string::npos)
-                        return std::nullopt;
-                    num_val = std::stoull(val_str, nullptr, 16);
-                } else if (type_char == 'd' || type_char == 'D') {
-                    if (val_str.find_first_not_of("0123456789xzXZ") !=
-                            std::string::npos ||
-                        val_str.find_first_of("xzXZ") != std::string::npos)
-                        return std::nullopt;
-                    num_val = std::stoull(val_str, nullptr, 10);
-                } else if (type_char == 'o' || type_char == 'O') {
-                    if (val_str.find_first_not_of("01234567xzXZ") !=
-                            std::string::npos ||
-                        val_str.find_first_of("xzXZ") != std::string::npos)
-                        return std::nullopt;
-                    num_val = std::stoull(val_str, nullptr, 8);
-                } else
-                    return std::nullopt;
-                ec.value = static_cast<long long>(num_val);
-                ec.is_zero = (num_val == 0);
-                if (ec.bit_width > 0 && ec.bit_width <= 64) {
-                    unsigned long long all_ones_mask =
-                        (ec.bit_width == 64) ? ULLONG_MAX
-                                             : (1ULL << ec.bit_width) - 1;
-                    ec.is_all_ones = (num_val == all_ones_mask);
-                } else if (ec.bit_width == 0)
-                    return std::nullopt;
-                if (ec.bit_width == 1 && num_val == 1)
-                    ec.is_all_ones = true;
-                if (ec.bit_width == 1 && num_val == 0)
-                    ec.is_zero = true;
-                return ec;
-            } else {
-                if (s.find_first_not_of("0123456789") != std::string::npos ||
-                    s.empty())
-                    return std::nullopt;
-                ec.value = std::stoll(s);
-                ec.is_zero = (ec.value == 0);
-                if (ec.value == 1) {
-                    ec.bit_width = 1;
-                    ec.is_all_ones = true;
-                } else if (ec.value == 0) {
-                    ec.bit_width = 1;
-                } else
-                    ec.bit_width = 32;
-                return ec;
-            }
-        } catch (const std::exception &e) {
-            return std::nullopt;
+class VerilogExpressionWriter {
+  public:
+    VerilogExpressionWriter(const ExpressionGraph &expression_graph,
+                            const std::vector<int> &shared_wire_indices,
+                            std::ostream &output_stream)
+        : graph(expression_graph), wire_indices(shared_wire_indices),
+          out(output_stream) {}
+
+    void write_root(int id) { write_self(id); }
+
+    void write_definition(int id) { write_inline(id); }
+
+  private:
+    const ExpressionGraph &graph;
+    const std::vector<int> &wire_indices;
+    std::ostream &out;
+
+    void write_constant(uint64_t value, int width) {
+        out << width << "'h" << to_hex_string(value, width);
+    }
+
+    int get_operand_width(int id, int context_width) const {
+        const ExprNode &node = graph.node(id);
+        return node.op == ExprOp::Const && node.has_value ? context_width
+                                                          : node.width;
+    }
+
+    bool needs_padding(const ExprNode &node, int first, int last) const {
+        for (int k = first; k <= last; ++k)
+            if (get_operand_width(node.operands[k], node.width) == node.width)
+                return false;
+        return true;
+    }
+
+    void write_operand(int id, int context_width) {
+        const ExprNode &node = graph.node(id);
+        if (node.op == ExprOp::Const && node.has_value)
+            write_constant(node.value, context_width);
+        else if (wire_indices[id] >= 0)
+            out << "shared" << wire_indices[id];
+        else
+            write_inline(id);
+    }
+
+    void write_context_operand(const ExprNode &node, int k, bool pad) {
+        if (pad)
+            out << "{" << node.width - graph.node(node.operands[k]).width
+                << "'h0, ";
+        write_operand(node.operands[k], node.width);
+        if (pad)
+            out << "}";
+    }
+
+    void write_inline(int id) {
+        const ExprNode &node = graph.node(id);
+        switch (node.op) {
+        case ExprOp::Var:
+            out << "var_" << node.var_id;
+            return;
+        case ExprOp::Const:
+            if (node.has_value)
+                write_constant(node.value, node.width);
+            else
+                out << graph.literal(node.literal_id);
+            return;
+        case ExprOp::BitNeg:
+        case ExprOp::Minus:
+            out << (node.op == ExprOp::BitNeg ? "~(" : "-(");
+            write_context_operand(node, 0, needs_padding(node, 0, 0));
+            out << ")";
+            return;
+        case ExprOp::LogNeg:
+            out << "!(";
+            write_self(node.operands[0]);
+            out << ")";
+            return;
+        case ExprOp::LogAnd:
+        case ExprOp::LogOr:
+            out << "(";
+            write_self(node.operands[0]);
+            out << (node.op == ExprOp::LogAnd ? " && " : " || ");
+            write_self(node.operands[1]);
+            out << ")";
+            return;
+        case ExprOp::Eq:
+        case ExprOp::Neq:
+        case ExprOp::Lt:
+        case ExprOp::Le: {
+            int compare_width = std::max(graph.node(node.operands[0]).width,
+                                         graph.node(node.operands[1]).width);
+            out << "(";
+            write_operand(node.operands[0], compare_width);
+            out << " " << get_operator_symbol(node.op) << " ";
+            write_operand(node.operands[1], compare_width);
+            out << ")";
+            return;
+        }
+        case ExprOp::Shl:
+        case ExprOp::Shr:
+            out << "(";
+            write_context_operand(node, 0, needs_padding(node, 0, 0));
+            out << " " << get_operator_symbol(node.op) << " ";
+            write_self(node.operands[1]);
+            out << ")";
+            return;
+        case ExprOp::Tern:
+            out << "(";
+            write_self(node.operands[0]);
+            out << " ? ";
+            write_context_operand(node, 1, needs_padding(node, 1, 2));
+            out << " : ";
+            write_context_operand(node, 2, false);
+            out << ")";
+            return;
+        default:
+            out << "(";
+            write_context_operand(node, 0, needs_padding(node, 0, 1));
+            out << " " << get_operator_symbol(node.op) << " ";
+            write_context_operand(node, 1, false);
+            out << ")";
+            return;
         }
-        return std::nullopt;
     }
-};
 
-struct ExpressionDetail {
-    string verilog_expr_str;
-    std::set<int> variable_ids;
-    std::optional<bool> const_expr_evaluates_to_nonzero;
+    void write_self(int id) { write_operand(id, graph.node(id).width); }
+
+    static const char *get_operator_symbol(ExprOp op) {
+        switch (op) {
+        case ExprOp::Add:
+            return "+";
+        case ExprOp::Sub:
+            return "-";
+        case ExprOp::Mul:
+            return "*";
+        case ExprOp::Div:
+            return "/";
+        case ExprOp::Mod:
+            return "%";
+        case ExprOp::Shl:
+            return "<<";
+        case ExprOp::Shr:
+            return ">>";
+        case ExprOp::BitAnd:
+            return "&";
+        case ExprOp::BitOr:
+            return "|";
+        case ExprOp::BitXor:
+            return "^";
+        case ExprOp::Eq:
+            return "==";
+        case ExprOp::Neq:
+            return "!=";
+        case ExprOp::Lt:
+            return "<";
+        default:
+            return "<=";
+        }
+    }
 };
 
+static std::vector<int> get_shared_wire_indices(const ExpressionGraph &graph,
+                                                const std::vector<int> &roots) {
+    std::vector<int> use_counts(graph.size(), 0);
+    for (int root : roots)
+        ++use_counts[root];
+    for (int id = graph.size() - 1; id >= 0; --id)
+        if (use_counts[id] > 0)
+            for (int operand : graph.node(id).operands)
+                ++use_counts[operand];
+    std::vector<int> wire_indices(graph.size(), -1);
+    int num_shared = 0;
+    for (int id = 0; id < graph.size(); ++id)
+        if (use_counts[id] > 1 && graph.node(id).op != ExprOp::Var &&
+            graph.node(id).op != ExprOp::Const)
+            wire_indices[id] = num_shared++;
+    return wire_indices;
+}
+
 struct ConstraintInternalInfo {
-    string verilog_expression_body;
-    std::set<int> variable_ids;
+    int expression_id;
+    std::vector<int> variable_ids;
     string assigned_wire_name;
     int original_json_constraint_index;
     int original_overall_idx;
     std::optional<bool> determined_wire_value;
 };
 
-static ExpressionDetail get_expression_details(
-    const json &node,
-    std::map<std::string, ExpressionDetail> &all_divisors_map);
-
-static ExpressionDetail get_expression_details(
-    const json &node,
-    std::map<std::string, ExpressionDetail> &all_divisors_map) {
-    ExpressionDetail current_detail;
-    string type = node["op"];
-    current_detail.const_expr_evaluates_to_nonzero = std::nullopt;
-    if (type == "VAR") {
-        int id = node.value("id", 0);
-        current_detail.verilog_expr_str = "var_" + to_string(id);
-        current_detail.variable_ids.insert(id);
-    } else if (type == "CONST") {
-        current_detail.verilog_expr_str = node.value("value", "1'b0");
-        std::optional<EvaluatedConstant> ec =
-            EvaluatedConstant::from_verilog_string(
-                current_detail.verilog_expr_str);
-        if (ec.has_value())
-            current_detail.const_expr_evaluates_to_nonzero = !ec->is_zero;
-    } else if (type == "BIT_NEG" || type == "LOG_NEG" || type == "MINUS") {
-        ExpressionDetail lhs_detail =
-            get_expression_details(node["lhs_expression"], all_divisors_map);
-        current_detail.variable_ids = lhs_detail.variable_ids;
-        string op_symbol_default;
-        if (type == "BIT_NEG")
-            op_symbol_default = "~";
-        else if (type == "LOG_NEG")
-            op_symbol_default = "!";
-        else if (type == "MINUS")
-            op_symbol_default = "-";
-        bool evaluated = false;
-        if (lhs_detail.const_expr_evaluates_to_nonzero.has_value()) {
-            std::optional<EvaluatedConstant> ec_lhs =
-                EvaluatedConstant::from_verilog_string(
-                    lhs_detail.verilog_expr_str);
-            if (ec_lhs.has_value()) {
-                if (type == "LOG_NEG") {
-                    current_detail.const_expr_evaluates_to_nonzero =
-                        ec_lhs->is_zero;
-                    current_detail.verilog_expr_str =
-                        (ec_lhs->is_zero) ? "1'b1" : "1'b0";
-                    evaluated = true;
-                }
-            }
-        }
-        if (!evaluated) {
-            current_detail.verilog_expr_str =
-                op_symbol_default + "(" + lhs_detail.verilog_expr_str + ")";
-            current_detail.const_expr_evaluates_to_nonzero = std::nullopt;
-        }
-    } else {
-        ExpressionDetail lhs_detail =
-            get_expression_details(node["lhs_expression"], all_divisors_map);
-        ExpressionDetail rhs_detail =
-            get_expression_details(node["rhs_expression"], all_divisors_map);
-        current_detail.variable_ids = lhs_detail.variable_ids;
-        current_detail.variable_ids.insert(rhs_detail.variable_ids.begin(),
-                                           rhs_detail.variable_ids.end());
-        if (type == "DIV" || type == "MOD") {
-            if (all_divisors_map.find(rhs_detail.verilog_expr_str) ==
-                all_divisors_map.end()) {
-                bool rhs_is_const_nonzero =
-                    rhs_detail.const_expr_evaluates_to_nonzero.has_value() &&
-                    rhs_detail.const_expr_evaluates_to_nonzero.value();
-                if (!rhs_is_const_nonzero)
-                    all_divisors_map[rhs_detail.verilog_expr_str] = rhs_detail;
-            }
-        }
-        bool evaluated_binary_const = false;
-        if (lhs_detail.const_expr_evaluates_to_nonzero.has_value() &&
-            rhs_detail.const_expr_evaluates_to_nonzero.has_value()) {
-            std::optional<EvaluatedConstant> ec_lhs =
-                EvaluatedConstant::from_verilog_string(
-                    lhs_detail.verilog_expr_str);
-            std::optional<EvaluatedConstant> ec_rhs =
-                EvaluatedConstant::from_verilog_string(
-                    rhs_detail.verilog_expr_str);
-            if (ec_lhs.has_value() && ec_rhs.has_value()) {
-                bool result_is_nonzero = false;
-                bool evaluable = true;
-                if (type == "EQ")
-                    result_is_nonzero = (ec_lhs->value == ec_rhs->value);
-                else if (type == "NEQ")
-                    result_is_nonzero = (ec_lhs->value != ec_rhs->value);
-                else if (type == "LOG_AND")
-                    result_is_nonzero = (!ec_lhs->is_zero && !ec_rhs->is_zero);
-                else if (type == "LOG_OR")
-                    result_is_nonzero = (!ec_lhs->is_zero || !ec_rhs->is_zero);
-                else
-                    evaluable = false;
-                if (evaluable) {
-                    current_detail.const_expr_evaluates_to_nonzero =
-                        result_is_nonzero;
-                    current_detail.verilog_expr_str =
-                        result_is_nonzero ? "1'b1" : "1'b0";
-                    evaluated_binary_const = true;
-                }
-            }
-        }
-        if (!evaluated_binary_const) {
-            current_detail.const_expr_evaluates_to_nonzero = std::nullopt;
-            string op_symbol;
-            if (type == "IMPLY") {
-                current_detail.verilog_expr_str =
-                    "( (!(" + lhs_detail.verilog_expr_str + ")) || (" +
-                    rhs_detail.verilog_expr_str + ") )";
-            } else {
-                if (type == "ADD")
-                    op_symbol = "+";
-                else if (type == "SUB")
-                    op_symbol = "-";
-                else if (type == "MUL")
-                    op_symbol = "*";
-                else if (type == "DIV")
-                    op_symbol = "/";
-                else if (type == "MOD")
-                    op_symbol = "%";
-                else if (type == "LSHIFT")
-                    op_symbol = "<<";
-                else if (type == "RSHIFT")
-                    op_symbol = ">>";
-                else if (type == "BIT_AND")
-                    op_symbol = "&";
-                else if (type == "BIT_OR")
-                    op_symbol = "|";
-                else if (type == "BIT_XOR")
-                    op_symbol = "^";
-                else if (type == "LOG_AND")
-                    op_symbol = "&&";
-                else if (type == "LOG_OR")
-                    op_symbol = "||";
-                else if (type == "EQ")
-                    op_symbol = "==";
-                else if (type == "NEQ")
-                    op_symbol = "!=";
-                else if (type == "LT")
-                    op_symbol = "<";
-                else if (type == "LTE")
-                    op_symbol == "<=";
-                else if (type == "GT")
-                    op_symbol == ">";
-                else if (type == "GTE")
-                    op_symbol == ">=";
-                else {
-                    current_detail.verilog_expr_str =
-                        "/* UNHANDLED_OP_STR: " + type + " */";
-                    return current_detail;
-                }
-                current_detail.verilog_expr_str =
-                    "(" + lhs_detail.verilog_expr_str + " " + op_symbol + " " +
-                    rhs_detail.verilog_expr_str + ")";
-            }
-        }
-    }
-    return current_detail;
-}
-
 struct DSUComponentForOrdering {
     int root_representative_idx;
     size_t num_constraints;
@@ -291,12 +220,12 @@ struct DSUComponentForOrdering {
     std::vector<int> effective_constraint_indices_in_component;
 };
 
-static std::vector<std::string> get_ordered_wires_by_dsu_strategy(
-    const std::vector<ConstraintInternalInfo> &effective_constraints) {
-    std::vector<std::string> final_ordered_wires;
-    if (effective_constraints.empty())
-        return final_ordered_wires;
-    int num_effective = effective_constraints.size();
+std::vector<std::vector<int>> get_constraint_components_by_dsu_strategy(
+    const std::vector<std::set<int>> &constraint_variable_ids) {
+    std::vector<std::vector<int>> ordered_components;
+    if (constraint_variable_ids.empty())
+        return ordered_components;
+    int num_effective = constraint_variable_ids.size();
     std::vector<int> dsu_parent(num_effective);
     std::iota(dsu_parent.begin(), dsu_parent.end(), 0);
     std::function<int(int)> find_set = [&](int i) -> int {
@@ -312,7 +241,7 @@ static std::vector<std::string> get_ordered_wires_by_dsu_strategy(
     };
     std::map<int, std::vector<int>> var_to_effective_idx_map;
     for (int i = 0; i < num_effective; ++i)
-        for (int var_id : effective_constraints[i].variable_ids)
+        for (int var_id : constraint_variable_ids[i])
             var_to_effective_idx_map[var_id].push_back(i);
     for (const auto &pair_var_indices : var_to_effective_idx_map) {
         const std::vector<int> &indices = pair_var_indices.second;
@@ -332,9 +261,8 @@ static std::vector<std::string> get_ordered_wires_by_dsu_strategy(
             comp.effective_constraint_indices_in_component.size();
         std::set<int> component_pis;
         for (int eff_idx : comp.effective_constraint_indices_in_component) {
-            component_pis.insert(
-                effective_constraints[eff_idx].variable_ids.begin(),
-                effective_constraints[eff_idx].variable_ids.end());
+            component_pis.insert(constraint_variable_ids[eff_idx].begin(),
+                                 constraint_variable_ids[eff_idx].end());
         }
         comp.total_pi_support_size = component_pis.size();
         comp.size_metric = comp.num_constraints;
@@ -348,11 +276,39 @@ static std::vector<std::string> get_ordered_wires_by_dsu_strategy(
             return a.root_representative_idx < b.root_representative_idx;
         });
     for (const auto &comp_info : component_list)
-        for (int effective_idx :
-             comp_info.effective_constraint_indices_in_component)
-            final_ordered_wires.push_back(
+        ordered_components.push_back(
+            comp_info.effective_constraint_indices_in_component);
+    return ordered_components;
+}
+
+static std::vector<std::vector<std::string>>
+get_component_wires_by_dsu_strategy(
+    const std::vector<ConstraintInternalInfo> &effective_constraints) {
+    std::vector<std::vector<std::string>> component_wires;
+    std::vector<std::set<int>> constraint_variable_ids;
+    for (const auto &info : effective_constraints)
+        constraint_variable_ids.emplace_back(info.variable_ids.begin(),
+                                             info.variable_ids.end());
+    for (const auto &component :
+         get_constraint_components_by_dsu_strategy(constraint_variable_ids)) {
+        std::vector<std::string> wires;
+        for (int effective_idx : component)
+            wires.push_back(
                 effective_constraints[effective_idx].assigned_wire_name);
-    return final_ordered_wires;
+        component_wires.push_back(wires);
+    }
+    return component_wires;
+}
+
+static void describe_constraint(ExpressionGraph &graph, int id,
+                                ConstraintInternalInfo &info) {
+    info.expression_id = id;
+    graph.collect_variable_ids(id, info.variable_ids);
+    uint64_t value = 0;
+    if (graph.get_constant(id, value))
+        info.determined_wire_value = value != 0;
+    else
+        info.determined_wire_value = std::nullopt;
 }
 
 int json_v_converter(const string &input_json_path,
@@ -372,101 +328,49 @@ int json_v_converter(const string &input_json_path,
         !data.contains("constraint_list") ||
         !data["constraint_list"].is_array())
         return 1;
-    vector<string> v_lines;
-    json variable_list = data["variable_list"];
-    json constraint_list_json = data["constraint_list"];
-    v_lines.push_back("module from_json(");
-    for (const auto &var : variable_list) {
-        if (!var.contains("name") || !var["name"].is_string() ||
-            !var.contains("bit_width") || !var["bit_width"].is_number())
-            continue;
-        string name = var.value("name", "default_name");
-        int bit_width = var.value("bit_width", 1);
-        v_lines.push_back("     input wire [" + to_string(bit_width - 1) +
-                          ":0] " + name + ",");
-    }
-    v_lines.push_back("     output wire result");
-    v_lines.push_back(");");
+    const json &variable_list = data["variable_list"];
+    const json &constraint_list_json = data["constraint_list"];
     std::vector<ConstraintInternalInfo> all_constraints_info_orig;
-    std::map<std::string, ExpressionDetail> all_found_divisors_map;
-    int current_idx_counter = 0;
-    for (size_t i = 0; i < constraint_list_json.size(); ++i) {
-        const auto &cnstr_json_node = constraint_list_json[i];
-        ExpressionDetail detail =
-            get_expression_details(cnstr_json_node, all_found_divisors_map);
-        ConstraintInternalInfo info;
-        info.verilog_expression_body = detail.verilog_expr_str;
-        info.variable_ids = detail.variable_ids;
-        info.assigned_wire_name =
-            "cnstr" + to_string(current_idx_counter) + "_redor";
-        info.original_json_constraint_index = static_cast<int>(i);
-        info.original_overall_idx = current_idx_counter;
-        if (detail.const_expr_evaluates_to_nonzero.has_value())
-            info.determined_wire_value =
-                detail.const_expr_evaluates_to_nonzero.value();
-        else
-            info.determined_wire_value = std::nullopt;
-        all_constraints_info_orig.push_back(info);
-        current_idx_counter++;
+    ExpressionGraph expression_graph(variable_list);
+    std::vector<int> constraint_roots;
+    try {
+        constraint_roots =
+            lower_constraint_list(expression_graph, constraint_list_json);
+    } catch (const std::exception &e) {
+        return 1;
     }
-    for (const auto &pair_str_detail : all_found_divisors_map) {
-        const ExpressionDetail &div_detail = pair_str_detail.second;
+    bool result_is_const_zero = false;
+    for (size_t k = 0; k < constraint_roots.size(); ++k) {
         ConstraintInternalInfo info;
-        string divisor_expr_str = div_detail.verilog_expr_str;
-        info.verilog_expression_body = "(" + divisor_expr_str + " != 0)";
-        info.variable_ids = div_detail.variable_ids;
-        info.assigned_wire_name =
-            "cnstr" + to_string(current_idx_counter) + "_redor";
-        info.original_json_constraint_index = -1;
-        info.original_overall_idx = current_idx_counter;
-        if (div_detail.const_expr_evaluates_to_nonzero.has_value())
-            info.determined_wire_value =
-                div_detail.const_expr_evaluates_to_nonzero.value();
-        else
-            info.determined_wire_value = std::nullopt;
+        describe_constraint(expression_graph, constraint_roots[k], info);
+        info.assigned_wire_name = "cnstr" + to_string(k) + "_redor";
+        info.original_json_constraint_index =
+            k < constraint_list_json.size() ? static_cast<int>(k) : -1;
+        info.original_overall_idx = static_cast<int>(k);
         all_constraints_info_orig.push_back(info);
-        current_idx_counter++;
     }
-    bool result_is_const_zero = false;
     for (const auto &info : all_constraints_info_orig)
         if (info.determined_wire_value.has_value() &&
             !info.determined_wire_value.value()) {
             result_is_const_zero = true;
             break;
         }
-    for (const auto &info : all_constraints_info_orig) {
-        v_lines.push_back("     wire " + info.assigned_wire_name + ";");
-        if (info.determined_wire_value.has_value())
-            v_lines.push_back(
-                "     assign " + info.assigned_wire_name + " = " +
-                (info.determined_wire_value.value() ? "1'b1;" : "1'b0;"));
-        else
-            v_lines.push_back("     assign " + info.assigned_wire_name +
-                              " = |(" + info.verilog_expression_body + ");");
-    }
+    std::vector<int> expression_roots;
+    for (const auto &info : all_constraints_info_orig)
+        if (!info.determined_wire_value.has_value())
+            expression_roots.push_back(info.expression_id);
     std::vector<ConstraintInternalInfo> effective_constraints_for_result;
     if (!result_is_const_zero)
         for (const auto &info : all_constraints_info_orig)
             if (!(info.determined_wire_value.has_value() &&
                   info.determined_wire_value.value()))
                 effective_constraints_for_result.push_back(info);
-    std::vector<std::string> final_ordered_result_wire_names;
+    std::vector<std::string> result_wire_names;
     if (!result_is_const_zero && !effective_constraints_for_result.empty())
-        final_ordered_result_wire_names =
-            get_ordered_wires_by_dsu_strategy(effective_constraints_for_result);
-    string result_assign = "     assign result = ";
-    if (result_is_const_zero)
-        result_assign += "1'b0;";
-    else if (final_ordered_result_wire_names.empty())
-        result_assign += "1'b1;";
-    else
-        for (size_t i = 0; i < final_ordered_result_wire_names.size(); ++i) {
-            result_assign += final_ordered_result_wire_names[i];
-            result_assign +=
-                (i == final_ordered_result_wire_names.size() - 1) ? ";" : " & ";
-        }
-    v_lines.push_back(result_assign);
-    v_lines.push_back("endmodule");
+        for (const auto &wire_names : get_component_wires_by_dsu_strategy(
+                 effective_constraints_for_result))
+            result_wire_names.insert(result_wire_names.end(),
+                                     wire_names.begin(), wire_names.end());
     filesystem::path input_json_path_obj(input_json_path);
     string filename_no_ext = input_json_path_obj.stem().string();
     string parent_dir_name =
@@ -482,8 +386,65 @@ int json_v_converter(const string &input_json_path,
     ofstream output_v_stream(output_v_path);
     if (!output_v_stream.is_open())
         return 1;
-    for (const string &line : v_lines)
-        output_v_stream << line << endl;
+    output_v_stream << "module from_json(\n";
+    for (const auto &var : variable_list) {
+        if (!var.contains("name") || !var["name"].is_string() ||
+            !var.contains("bit_width") || !var["bit_width"].is_number())
+            continue;
+        output_v_stream << "     input wire [" << var.value("bit_width", 1) - 1
+                        << ":0] "
+                        << var["name"].get_ref<const std::string &>()
+                        << ",\n";
+    }
+    size_t num_outputs = result_wire_names.size();
+    if (num_outputs > 1)
+        output_v_stream << "     output wire [" << num_outputs - 1
+                        << ":0] result\n";
+    else
+        output_v_stream << "     output wire result\n";
+    output_v_stream << ");\n";
+    std::vector<int> shared_wire_indices =
+        get_shared_wire_indices(expression_graph, expression_roots);
+    VerilogExpressionWriter expression_writer(
+        expression_graph, shared_wire_indices, output_v_stream);
+    for (int id = 0; id < expression_graph.size(); ++id) {
+        if (shared_wire_indices[id] < 0)
+            continue;
+        int width = expression_graph.node(id).width;
+        output_v_stream << "     wire ";
+        if (width > 1)
+            output_v_stream << "[" << width - 1 << ":0] ";
+        output_v_stream << "shared" << shared_wire_indices[id] << ";\n";
+        output_v_stream << "     assign shared" << shared_wire_indices[id]
+                        << " = ";
+        expression_writer.write_definition(id);
+        output_v_stream << ";\n";
+    }
+    for (const auto &info : all_constraints_info_orig) {
+        output_v_stream << "     wire " << info.assigned_wire_name << ";\n";
+        output_v_stream << "     assign " << info.assigned_wire_name << " = ";
+        if (info.determined_wire_value.has_value())
+            output_v_stream
+                << (info.determined_wire_value.value() ? "1'b1" : "1'b0");
+        else {
+            output_v_stream << "|(";
+            expression_writer.write_root(info.expression_id);
+            output_v_stream << ")";
+        }
+        output_v_stream << ";\n";
+    }
+    if (result_is_const_zero)
+        output_v_stream << "     assign result = 1'b0;\n";
+    else if (result_wire_names.empty())
+        output_v_stream << "     assign result = 1'b1;\n";
+    else
+        for (size_t k = 0; k < num_outputs; ++k) {
+            output_v_stream << "     assign result";
+            if (num_outputs > 1)
+                output_v_stream << "[" << k << "]";
+            output_v_stream << " = " << result_wire_names[k] << ";\n";
+        }
+    output_v_stream << "endmodule\n";
     output_v_stream.close();
-    return 0;
-}
\ No newline at end of file
+    return output_v_stream.fail() ? 1 : 0;
+}
@@ -1,25 +1,231 @@
+#include <charconv>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
+#include "mapped_file.h"
+#include "result_writer.h"
 #include "solver_functions.h"
 int json_v_converter(const std::string &input_json_path,
                      const std::string &output_v_dir);
 using namespace std;
 using namespace std::filesystem;
+template <typename T>
+static bool parse_non_negative(const string &text, T &value) {
+    const char *end = text.data() + text.size();
+    auto [parsed_end, error] = from_chars(text.data(), end, value);
+    return error == errc() && parsed_end == end && !(value < 0);
+}
+bool parse_solver_options(int argc, char *argv[], int first_option_idx,
+                          SolverOptions &options) {
+    for (int i = first_option_idx; i < argc; ++i) {
+        string option = argv[i];
+        bool valid_value = true;
+        if (option == "--threads" && i + 1 < argc)
+            valid_value = parse_non_negative(argv[++i], options.num_threads);
+        else if (option == "--count-engine" && i + 1 < argc)
+            options.count_engine = argv[++i];
+        else if (option == "--sampler" && i + 1 < argc)
+            options.sampler = argv[++i];
+        else if (option == "--benchmark-count")
+            options.benchmark_count_engines = true;
+        else if (option == "--var-order" && i + 1 < argc)
+            options.variable_order = argv[++i];
+        else if (option == "--order-probe-limit" && i + 1 < argc)
+            valid_value =
+                parse_non_negative(argv[++i], options.order_probe_node_limit);
+        else if (option == "--var-groups" && i + 1 < argc)
+            options.variable_groups = argv[++i];
+        else if (option == "--conjoin" && i + 1 < argc)
+            options.conjoin_schedule = argv[++i];
+        else if (option == "--reorder" && i + 1 < argc)
+            options.reorder_method = argv[++i];
+        else if (option == "--reorder-growth" && i + 1 < argc)
+            valid_value =
+                parse_non_negative(argv[++i], options.reorder_max_growth);
+        else if (option == "--reorder-threshold" && i + 1 < argc)
+            valid_value =
+                parse_non_negative(argv[++i], options.reorder_first_threshold);
+        else if (option == "--reorder-max-count" && i + 1 < argc)
+            valid_value =
+                parse_non_negative(argv[++i], options.reorder_max_count);
+        else if (option == "--reorder-time-budget" && i + 1 < argc)
+            valid_value =
+                parse_non_negative(argv[++i], options.reorder_time_budget_ms);
+        else if (option == "--final-reorder")
+            options.final_reorder = true;
+        else if (option == "--log-reorder")
+            options.log_reorder_events = true;
+        else if (option == "--compact-output")
+            options.pretty_print_results = false;
+        else if (option == "--output-format" && i + 1 < argc)
+            options.output_format = argv[++i];
+        else if (option == "--socket" && i + 1 < argc)
+            options.server_socket_path = argv[++i];
+        else if (option == "--cache-size" && i + 1 < argc)
+            valid_value =
+                parse_non_negative(argv[++i], options.server_cache_size);
+        else if (option == "--cache-dir" && i + 1 < argc)
+            options.cache_dir = argv[++i];
+        else if (option == "--cache-lookup")
+            options.cache_lookup_only = true;
+        else
+            return false;
+        if (!valid_value)
+            return false;
+    }
+    if (options.count_engine != "exact" && options.count_engine != "scaled" &&
+        options.count_engine != "quad")
+        return false;
+    if (options.sampler != "batch" && options.sampler != "walk")
+        return false;
+    if (options.output_format != "json" && options.output_format != "binary")
+        return false;
+    if (options.variable_order != "auto" && options.variable_order != "dfs" &&
+        options.variable_order != "force" &&
+        options.variable_order != "interleave" &&
+        options.variable_order != "declaration")
+        return false;
+    if (options.variable_groups != "none" && options.variable_groups != "msb" &&
+        options.variable_groups != "lsb" &&
+        options.variable_groups != "interleave")
+        return false;
+    if (options.conjoin_schedule != "heap" &&
+        options.conjoin_schedule != "support")
+        return false;
+    if (options.reorder_method != "none" && options.reorder_method != "sift" &&
+        options.reorder_method != "symmetric" &&
+        options.reorder_method != "group" &&
+        options.reorder_method != "window" &&
+        options.reorder_method != "annealing")
+        return false;
+    return options.num_threads > 0 && options.order_probe_node_limit > 0 &&
+           options.server_cache_size > 0 &&
+           options.reorder_max_growth >= 1.0 &&
+           options.reorder_time_budget_ms >= 0;
+}
+static bool has_aig_order_options(int argc, char *argv[],
+                                  int first_option_idx) {
+    for (int i = first_option_idx; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--var-order" || option == "--order-probe-limit" ||
+            option == "--conjoin")
+            return true;
+    }
+    return false;
+}
+static bool read_sampling_jobs(const string &jobs_path,
+                               vector<SamplingJob> &jobs) {
+    ifstream jobs_stream(jobs_path);
+    if (!jobs_stream.is_open())
+        return false;
+    set<string> result_paths;
+    string line;
+    while (getline(jobs_stream, line)) {
+        istringstream line_stream(line);
+        string num_samples, result_path, random_seed, extra;
+        if (!(line_stream >> num_samples))
+            continue;
+        if (!(line_stream >> result_path >> random_seed) ||
+            line_stream >> extra || !result_paths.insert(result_path).second)
+            return false;
+        SamplingJob job{0, 0, result_path};
+        if (!parse_non_negative(random_seed, job.random_seed) ||
+            !parse_non_negative(num_samples, job.num_samples))
+            return false;
+        jobs.push_back(job);
+    }
+    return !jobs.empty();
+}
+static int binary_to_json(const string &binary_path, const string &json_path,
+                          const SolverOptions &options) {
+    MappedFile binary_file(binary_path);
+    if (!binary_file.is_open())
+        return 1;
+    BinaryResultView samples(binary_file.begin(), binary_file.end());
+    if (!samples.is_valid())
+        return 1;
+    ResultWriter writer(samples.get_ids(), samples.get_widths());
+    return writer.write_json(json_path, samples[0], samples.size(),
+                             samples.get_words_per_sample(),
+                             options.pretty_print_results)
+               ? 0
+               : 1;
+}
 int main(int argc, char *argv[]) {
+    SolverOptions options;
     if (argc == 4 && string(argv[1]) == "json-to-v") {
         string input_json_path_str = argv[2];
         string output_v_dir_str = argv[3];
         return json_v_converter(input_json_path_str, output_v_dir_str);
-    } else if (argc == 7 && string(argv[1]) == "aig-to-bdd") {
+    } else if (argc >= 7 && string(argv[1]) == "aig-to-bdd") {
         string aig_file_path = argv[2];
         string original_json_path = argv[3];
-        int num_samples = stoi(argv[4]);
         string result_json_path = argv[5];
-        unsigned int random_seed = stoul(argv[6]);
-        return aig_to_bdd_solver(aig_file_path, original_json_path, num_samples,
-                                 result_json_path, random_seed);
+        int num_samples = 0;
+        unsigned int random_seed = 0;
+        if (!parse_non_negative(argv[4], num_samples) ||
+            !parse_non_negative(argv[6], random_seed) ||
+            !parse_solver_options(argc, argv, 7, options))
+            return 1;
+        return aig_to_bdd_solver(aig_file_path, original_json_path,
+                                 {{random_seed, num_samples, result_json_path}},
+                                 options);
+    } else if (argc >= 5 && string(argv[1]) == "aig-to-bdd-batch") {
+        vector<SamplingJob> jobs;
+        if (!read_sampling_jobs(argv[4], jobs) ||
+            !parse_solver_options(argc, argv, 5, options))
+            return 1;
+        return aig_to_bdd_solver(argv[2], argv[3], jobs, options);
+    } else if (argc >= 6 && string(argv[1]) == "solve") {
+        string input_json_path_str = argv[2];
+        string result_json_path = argv[4];
+        int num_samples = 0;
+        unsigned int random_seed = 0;
+        if (!parse_non_negative(argv[3], num_samples) ||
+            !parse_non_negative(argv[5], random_seed) ||
+            !parse_solver_options(argc, argv, 6, options))
+            return 1;
+        return json_aig_solver(input_json_path_str,
+                               {{random_seed, num_samples, result_json_path}},
+                               options);
+    } else if (argc >= 4 && string(argv[1]) == "solve-batch") {
+        vector<SamplingJob> jobs;
+        if (!read_sampling_jobs(argv[3], jobs) ||
+            !parse_solver_options(argc, argv, 4, options))
+            return 1;
+        return json_aig_solver(argv[2], jobs, options);
+    } else if (argc >= 6 && string(argv[1]) == "json-to-bdd") {
+        string input_json_path_str = argv[2];
+        string result_json_path = argv[4];
+        int num_samples = 0;
+        unsigned int random_seed = 0;
+        if (!parse_non_negative(argv[3], num_samples) ||
+            !parse_non_negative(argv[5], random_seed) ||
+            has_aig_order_options(argc, argv, 6) ||
+            !parse_solver_options(argc, argv, 6, options))
+            return 1;
+        return json_bdd_solver(input_json_path_str,
+                               {{random_seed, num_samples, result_json_path}},
+                               options);
+    } else if (argc >= 4 && string(argv[1]) == "json-to-bdd-batch") {
+        vector<SamplingJob> jobs;
+        if (has_aig_order_options(argc, argv, 4) ||
+            !read_sampling_jobs(argv[3], jobs) ||
+            !parse_solver_options(argc, argv, 4, options))
+            return 1;
+        return json_bdd_solver(argv[2], jobs, options);
+    } else if (argc >= 2 && string(argv[1]) == "serve") {
+        if (!parse_solver_options(argc, argv, 2, options))
+            return 1;
+        return solver_server(options);
+    } else if (argc >= 4 && string(argv[1]) == "binary-to-json") {
+        if (!parse_solver_options(argc, argv, 4, options))
+            return 1;
+        return binary_to_json(argv[2], argv[3], options);
     } else
         return 1;
 }
\ No newline at end of file
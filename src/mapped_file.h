@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string &path) {
+        fd = open(path.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if (fd < 0 || fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+            return;
+        size = file_stat.st_size;
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+            data = static_cast<const char *>(mapping);
+    }
+
+    ~MappedFile() {
+        if (data)
+            munmap(const_cast<char *>(data), size);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool is_open() const { return data != nullptr; }
+    const char *begin() const { return data; }
+    const char *end() const { return data + size; }
+
+  private:
+    int fd = -1;
+    size_t size = 0;
+    const char *data = nullptr;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef PACKED_ASSIGNMENT_SET_H
+#define PACKED_ASSIGNMENT_SET_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class PackedAssignmentSet {
+  public:
+    explicit PackedAssignmentSet(int words_per_assignment)
+        : words_per_assignment(words_per_assignment), slots(16, -1) {}
+
+    int size() const { return num_assignments; }
+
+    int get_words_per_assignment() const { return words_per_assignment; }
+
+    const uint64_t *data() const { return assignments.data(); }
+
+    bool insert(const uint64_t *assignment) {
+        if (2 * (num_assignments + 1) > static_cast<int>(slots.size()))
+            grow();
+        size_t slot = find_slot(assignment, hash(assignment));
+        if (slots[slot] >= 0)
+            return false;
+        slots[slot] = num_assignments++;
+        assignments.insert(assignments.end(), assignment,
+                           assignment + words_per_assignment);
+        return true;
+    }
+
+  private:
+    int words_per_assignment;
+    int num_assignments = 0;
+    std::vector<int> slots;
+    std::vector<uint64_t> assignments;
+
+    uint64_t hash(const uint64_t *assignment) const {
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for (int i = 0; i < words_per_assignment; ++i) {
+            h ^= assignment[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+            h ^= h >> 31;
+        }
+        return h;
+    }
+
+    const uint64_t *stored(int assignment_idx) const {
+        return &assignments[static_cast<size_t>(assignment_idx) *
+                            words_per_assignment];
+    }
+
+    size_t find_slot(const uint64_t *assignment, uint64_t h) const {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = h & mask;; slot = (slot + 1) & mask)
+            if (slots[slot] < 0 ||
+                std::memcmp(stored(slots[slot]), assignment,
+                            words_per_assignment * sizeof(uint64_t)) == 0)
+                return slot;
+    }
+
+    void grow() {
+        std::vector<int> old_slots(2 * slots.size(), -1);
+        old_slots.swap(slots);
+        for (int assignment_idx : old_slots)
+            if (assignment_idx >= 0)
+                slots[find_slot(stored(assignment_idx),
+                                hash(stored(assignment_idx)))] =
+                    assignment_idx;
+    }
+};
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef PATH_COUNT_ENGINES_H
+#define PATH_COUNT_ENGINES_H
+
+#include <quadmath.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Thresholds 0 and UINT64_MAX mean a branch is never or always taken, so a
+// split between two non-empty branches must stay strictly inside them.
+inline uint64_t clamp_threshold(unsigned __int128 threshold) {
+    if (threshold < 1)
+        return 1;
+    if (threshold > UINT64_MAX - 1)
+        return UINT64_MAX - 1;
+    return static_cast<uint64_t>(threshold);
+}
+
+class ExactCountEngine {
+  public:
+    using Word = uint64_t;
+
+    static constexpr const char *name = "exact";
+
+    explicit ExactCountEngine(int num_vars) : num_limbs(num_vars / 64 + 1) {}
+
+    int get_words_per_count() const { return num_limbs; }
+
+    void set_zero(Word *count) const { std::fill(count, count + num_limbs, 0); }
+
+    void set_one(Word *count) const {
+        set_zero(count);
+        count[0] = 1;
+    }
+
+    void add_scaled(Word *sum, const Word *lhs, int lhs_shift, const Word *rhs,
+                    int rhs_shift) const {
+        if (bit_length(lhs) + lhs_shift > 64 * num_limbs ||
+            bit_length(rhs) + rhs_shift > 64 * num_limbs)
+            throw std::overflow_error("Solution count exceeds limb capacity.");
+        unsigned __int128 carry = 0;
+        for (int i = 0; i < num_limbs; ++i) {
+            unsigned __int128 limb_sum =
+                static_cast<unsigned __int128>(
+                    bits_at(lhs, 64 * i - lhs_shift)) +
+                bits_at(rhs, 64 * i - rhs_shift) + carry;
+            sum[i] = static_cast<uint64_t>(limb_sum);
+            carry = limb_sum >> 64;
+        }
+        if (carry)
+            throw std::overflow_error("Solution count exceeds limb capacity.");
+    }
+
+    bool is_zero(const Word *count) const { return highest_limb(count) < 0; }
+
+    bool to_uint64(const Word *count, uint64_t &value) const {
+        if (highest_limb(count) > 0)
+            return false;
+        value = count[0];
+        return true;
+    }
+
+    uint64_t else_threshold(const Word *else_cnt, int else_shift,
+                            const Word *total) const {
+        int shift = std::max(0, bit_length(total) - 64);
+        unsigned __int128 quotient =
+            (static_cast<unsigned __int128>(
+                 bits_at(else_cnt, shift - else_shift))
+             << 64) /
+            bits_at(total, shift);
+        return clamp_threshold(quotient);
+    }
+
+    double log2(const Word *count) const {
+        int top_limb = highest_limb(count);
+        if (top_limb < 0)
+            return -INFINITY;
+        double leading = static_cast<double>(count[top_limb]);
+        if (top_limb > 0)
+            leading +=
+                std::ldexp(static_cast<double>(count[top_limb - 1]), -64);
+        return std::log2(leading) + 64.0 * top_limb;
+    }
+
+    double else_probability(const Word *else_cnt, int else_shift,
+                            const Word *total) const {
+        int shift = std::max(0, bit_length(total) - 64);
+        return static_cast<double>(bits_at(else_cnt, shift - else_shift)) /
+               static_cast<double>(bits_at(total, shift));
+    }
+
+  private:
+    int num_limbs;
+
+    int highest_limb(const Word *count) const {
+        for (int i = num_limbs - 1; i >= 0; --i)
+            if (count[i])
+                return i;
+        return -1;
+    }
+
+    int bit_length(const Word *count) const {
+        int top_limb = highest_limb(count);
+        if (top_limb < 0)
+            return 0;
+        return 64 * top_limb + 64 - __builtin_clzll(count[top_limb]);
+    }
+
+    // Returns bits [offset, offset + 64) of count; offset may be negative.
+    uint64_t bits_at(const Word *count, int offset) const {
+        int limb = offset >= 0 ? offset / 64 : -((63 - offset) / 64);
+        int bit = offset - 64 * limb;
+        auto limb_at = [&](int idx) {
+            return idx >= 0 && idx < num_limbs ? count[idx] : 0;
+        };
+        if (!bit)
+            return limb_at(limb);
+        return (limb_at(limb) >> bit) | (limb_at(limb + 1) << (64 - bit));
+    }
+};
+
+struct ScaledCount {
+    double mantissa;
+    int64_t exponent;
+};
+
+class ScaledCountEngine {
+  public:
+    using Word = ScaledCount;
+
+    static constexpr const char *name = "scaled";
+
+    explicit ScaledCountEngine(int num_vars [[maybe_unused]]) {}
+
+    int get_words_per_count() const { return 1; }
+
+    void set_zero(Word *count) const { *count = {0.0, 0}; }
+
+    void set_one(Word *count) const { *count = normalize(1.0, 0); }
+
+    void add_scaled(Word *sum, const Word *lhs, int lhs_shift, const Word *rhs,
+                    int rhs_shift) const {
+        if (lhs->mantissa == 0.0) {
+            *sum = {rhs->mantissa, rhs->exponent + rhs_shift};
+            return;
+        }
+        if (rhs->mantissa == 0.0) {
+            *sum = {lhs->mantissa, lhs->exponent + lhs_shift};
+            return;
+        }
+        int64_t lhs_exponent = lhs->exponent + lhs_shift;
+        int64_t rhs_exponent = rhs->exponent + rhs_shift;
+        bool lhs_larger = lhs_exponent >= rhs_exponent;
+        double larger = lhs_larger ? lhs->mantissa : rhs->mantissa;
+        double smaller = lhs_larger ? rhs->mantissa : lhs->mantissa;
+        int64_t exponent = std::max(lhs_exponent, rhs_exponent);
+        int64_t exponent_gap = exponent - std::min(lhs_exponent, rhs_exponent);
+        if (exponent_gap > 64)
+            *sum = {larger, exponent};
+        else
+            *sum = normalize(
+                larger + std::ldexp(smaller, -static_cast<int>(exponent_gap)),
+                exponent);
+    }
+
+    bool is_zero(const Word *count) const { return count->mantissa == 0.0; }
+
+    bool to_uint64(const Word *count, uint64_t &value) const {
+        if (count->exponent > 53)
+            return false;
+        value = static_cast<uint64_t>(
+            std::ldexp(count->mantissa, static_cast<int>(count->exponent)));
+        return true;
+    }
+
+    uint64_t else_threshold(const Word *else_cnt, int else_shift,
+                            const Word *total) const {
+        return clamp_threshold(static_cast<unsigned __int128>(std::ldexp(
+            else_probability(else_cnt, else_shift, total), 64)));
+    }
+
+    double log2(const Word *count) const {
+        if (count->mantissa == 0.0)
+            return -INFINITY;
+        return std::log2(count->mantissa) +
+               static_cast<double>(count->exponent);
+    }
+
+    double else_probability(const Word *else_cnt, int else_shift,
+                            const Word *total) const {
+        if (else_cnt->mantissa == 0.0 || total->mantissa == 0.0)
+            return 0.0;
+        int64_t exponent_gap =
+            else_cnt->exponent + else_shift - total->exponent;
+        if (exponent_gap < -1100)
+            return 0.0;
+        return std::min(1.0, std::ldexp(else_cnt->mantissa / total->mantissa,
+                                         static_cast<int>(exponent_gap)));
+    }
+
+  private:
+    static Word normalize(double mantissa, int64_t exponent) {
+        if (mantissa == 0.0)
+            return {0.0, 0};
+        int shift = 0;
+        double fraction = std::frexp(mantissa, &shift);
+        return {fraction, exponent + shift};
+    }
+};
+
+class QuadCountEngine {
+  public:
+    using Word = __float128;
+
+    static constexpr const char *name = "quad";
+
+    explicit QuadCountEngine(int num_vars [[maybe_unused]]) {}
+
+    int get_words_per_count() const { return 1; }
+
+    void set_zero(Word *count) const { *count = 0.0Q; }
+
+    void set_one(Word *count) const { *count = 1.0Q; }
+
+    void add_scaled(Word *sum, const Word *lhs, int lhs_shift, const Word *rhs,
+                    int rhs_shift) const {
+        *sum = ldexpq(*lhs, lhs_shift) + ldexpq(*rhs, rhs_shift);
+    }
+
+    bool is_zero(const Word *count) const { return *count <= 0.0Q; }
+
+    bool to_uint64(const Word *count, uint64_t &value) const {
+        if (*count >= 18446744073709551616.0Q)
+            return false;
+        value = static_cast<uint64_t>(*count);
+        return true;
+    }
+
+    uint64_t else_threshold(const Word *else_cnt, int else_shift,
+                            const Word *total) const {
+        return clamp_threshold(static_cast<unsigned __int128>(
+            ldexpq(*else_cnt, else_shift) / *total *
+            18446744073709551616.0Q));
+    }
+
+    double log2(const Word *count) const {
+        if (*count <= 0.0Q)
+            return -INFINITY;
+        return static_cast<double>(log2q(*count));
+    }
+
+    double else_probability(const Word *else_cnt, int else_shift,
+                            const Word *total) const {
+        if (*else_cnt <= 0.0Q)
+            return 0.0;
+        return static_cast<double>(ldexpq(*else_cnt, else_shift) / *total);
+    }
+};
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+const char BINARY_RESULT_MAGIC[8] = {'S', 'V', 'S', 'A', 'M', 'P', 'L', 'E'};
+const uint32_t BINARY_RESULT_VERSION = 1;
+
+struct BinaryResultHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_variables;
+    uint64_t num_samples;
+    uint32_t words_per_sample;
+    uint32_t reserved;
+};
+
+struct BinaryResultVariable {
+    int32_t id;
+    uint32_t bit_width;
+};
+
+class BinaryResultView {
+  public:
+    BinaryResultView(const char *begin, const char *end) {
+        size_t size = end - begin;
+        if (!begin || size < sizeof(BinaryResultHeader))
+            return;
+        std::memcpy(&header, begin, sizeof(header));
+        if (std::memcmp(header.magic, BINARY_RESULT_MAGIC, 8) != 0 ||
+            header.version != BINARY_RESULT_VERSION)
+            return;
+        size_t table_size =
+            header.num_variables * sizeof(BinaryResultVariable);
+        if (size - sizeof(header) < table_size)
+            return;
+        const char *table = begin + sizeof(header);
+        uint64_t total_bits = 0;
+        for (uint32_t k = 0; k < header.num_variables; ++k) {
+            BinaryResultVariable variable;
+            std::memcpy(&variable, table + k * sizeof(variable),
+                        sizeof(variable));
+            ids.push_back(variable.id);
+            widths.push_back(static_cast<int>(variable.bit_width));
+            total_bits += variable.bit_width;
+        }
+        size_t stride = header.words_per_sample * sizeof(uint64_t);
+        size_t records_size = size - sizeof(header) - table_size;
+        if (header.words_per_sample != (total_bits + 63) / 64)
+            return;
+        if (stride == 0 ? records_size != 0
+                        : records_size % stride != 0 ||
+                              records_size / stride != header.num_samples)
+            return;
+        records = reinterpret_cast<const uint64_t *>(table + table_size);
+        valid = true;
+    }
+
+    bool is_valid() const { return valid; }
+    uint64_t size() const { return header.num_samples; }
+    int get_words_per_sample() const { return header.words_per_sample; }
+    const std::vector<int> &get_ids() const { return ids; }
+    const std::vector<int> &get_widths() const { return widths; }
+
+    const uint64_t *operator[](uint64_t sample_idx) const {
+        return records + sample_idx * header.words_per_sample;
+    }
+
+  private:
+    BinaryResultHeader header = {};
+    std::vector<int> ids;
+    std::vector<int> widths;
+    const uint64_t *records = nullptr;
+    bool valid = false;
+};
+
+class ResultWriter {
+  public:
+    ResultWriter(const std::vector<int> &variable_ids,
+                 const std::vector<int> &variable_widths)
+        : ids(variable_ids), widths(variable_widths), buffer(BUFFER_SIZE) {}
+
+    bool write_json(const std::string &path, const uint64_t *samples,
+                    uint64_t num_samples, int words_per_sample,
+                    bool pretty_print) {
+        if (!open(path))
+            return false;
+        append(pretty_print ? "{\n    \"assignment_list\": ["
+                            : "{\"assignment_list\":[");
+        for (uint64_t i = 0; i < num_samples; ++i) {
+            append(i > 0 ? "," : "");
+            if (pretty_print)
+                append("\n        ");
+            write_assignment(samples + i * words_per_sample, pretty_print);
+        }
+        if (pretty_print && num_samples > 0)
+            append("\n    ");
+        append(pretty_print ? "]\n}\n" : "]}\n");
+        return close();
+    }
+
+    bool write_binary(const std::string &path, const uint64_t *samples,
+                      uint64_t num_samples, int words_per_sample) {
+        if (!open(path))
+            return false;
+        BinaryResultHeader header = {};
+        std::memcpy(header.magic, BINARY_RESULT_MAGIC, 8);
+        header.version = BINARY_RESULT_VERSION;
+        header.num_variables = static_cast<uint32_t>(widths.size());
+        header.num_samples = num_samples;
+        header.words_per_sample = static_cast<uint32_t>(words_per_sample);
+        append(&header, sizeof(header));
+        for (size_t k = 0; k < widths.size(); ++k) {
+            BinaryResultVariable variable = {
+                ids[k], static_cast<uint32_t>(widths[k])};
+            append(&variable, sizeof(variable));
+        }
+        append(samples, num_samples * words_per_sample * sizeof(uint64_t));
+        return close();
+    }
+
+  private:
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    std::vector<int> ids;
+    std::vector<int> widths;
+    std::vector<char> buffer;
+    size_t used = 0;
+    int fd = -1;
+    bool ok = true;
+
+    bool open(const std::string &path) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        used = 0;
+        ok = fd >= 0;
+        return ok;
+    }
+
+    bool close() {
+        flush();
+        return ::close(fd) == 0 && ok;
+    }
+
+    void flush() {
+        for (size_t written = 0; written < used && ok;) {
+            ssize_t n = ::write(fd, buffer.data() + written, used - written);
+            if (n <= 0)
+                ok = false;
+            else
+                written += static_cast<size_t>(n);
+        }
+        used = 0;
+    }
+
+    char *reserve(size_t length) {
+        if (used + length > buffer.size())
+            flush();
+        char *out = buffer.data() + used;
+        used += length;
+        return out;
+    }
+
+    void append(const void *data, size_t length) {
+        const char *bytes = static_cast<const char *>(data);
+        while (length > 0) {
+            size_t chunk = std::min(length, buffer.size());
+            std::memcpy(reserve(chunk), bytes, chunk);
+            bytes += chunk;
+            length -= chunk;
+        }
+    }
+
+    void append(const char *text) { append(text, std::strlen(text)); }
+
+    void write_assignment(const uint64_t *words, bool pretty_print) {
+        append("[");
+        int first_bit = 0;
+        for (size_t k = 0; k < widths.size(); ++k) {
+            append(k > 0 ? "," : "");
+            append(pretty_print
+                       ? "\n            {\n                \"value\": \""
+                       : "{\"value\":\"");
+            write_hex(words, first_bit, widths[k]);
+            append(pretty_print ? "\"\n            }" : "\"}");
+            first_bit += widths[k];
+        }
+        if (pretty_print && !widths.empty())
+            append("\n        ");
+        append("]");
+    }
+
+    void write_hex(const uint64_t *words, int first_bit, int width) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        int num_digits = (width + 3) / 4;
+        if (static_cast<size_t>(num_digits) > buffer.size())
+            buffer.resize(num_digits);
+        char *out = reserve(num_digits);
+        for (int digit = 0; digit < num_digits; ++digit) {
+            int bit = first_bit + 4 * digit;
+            int offset = bit % 64;
+            int num_bits = std::min(4, width - 4 * digit);
+            uint64_t nibble = words[bit / 64] >> offset;
+            if (offset + num_bits > 64)
+                nibble |= words[bit / 64 + 1] << (64 - offset);
+            out[num_digits - 1 - digit] =
+                HEX_DIGITS[nibble & ((1U << num_bits) - 1)];
+        }
+    }
+};
+
+#endif
@@ -1,16 +1,157 @@
 #ifndef SOLVER_FUNCTIONS_H
 #define SOLVER_FUNCTIONS_H
 
+#include "cudd.h"
 #include "nlohmann/json.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
+struct AigData {
+    int nM, nI, nL, nO, nA;
+    std::vector<int> primary_input_literals;
+    std::vector<int> input_index_by_var;
+    std::vector<int> circuit_output_literals;
+    std::vector<unsigned char> is_and_var;
+    std::vector<uint32_t> and_fanins;
+    std::vector<int> and_gate_vars;
+};
+
+struct InputBit {
+    int variable_id = -1;
+    int bit = 0;
+    int word_cluster = -1;
+};
+
+struct InputLayout {
+    std::vector<InputBit> input_bits;
+    std::vector<int> interleaved_bit_order;
+};
+
+struct SolverOptions {
+    int num_threads = 1;
+    std::string count_engine = "exact";
+    std::string sampler = "batch";
+    bool benchmark_count_engines = false;
+    std::string variable_order = "auto";
+    long order_probe_node_limit = 100000;
+    std::string variable_groups = "none";
+    std::string conjoin_schedule = "heap";
+    std::string reorder_method = "sift";
+    double reorder_max_growth = 1.2;
+    unsigned int reorder_first_threshold = 4004;
+    unsigned int reorder_max_count = 0;
+    long reorder_time_budget_ms = 0;
+    bool final_reorder = false;
+    bool log_reorder_events = false;
+    bool pretty_print_results = true;
+    std::string output_format = "json";
+    std::string server_socket_path;
+    int server_cache_size = 8;
+    std::string cache_dir;
+    bool cache_lookup_only = false;
+};
+
+struct SamplingJob {
+    unsigned int random_seed = 0;
+    int num_samples = 0;
+    std::string result_path;
+};
+
+class SupportSet;
+struct CompiledConstraints;
+
+struct ComponentBdd {
+    DdNode *output = nullptr;
+    std::vector<int> bit_indices;
+    std::vector<DdNode *> input_vars;
+};
+
+using ComponentBuilder =
+    std::function<bool(int component_idx, DdManager *manager,
+                       ComponentBdd &component)>;
+
 std::string to_hex_string(unsigned long long value, int bit_width);
 
 int aig_to_bdd_solver(const std::string &aig_file_path,
-                      const std::string &original_json_path, int num_samples,
-                      const std::string &result_json_path,
-                      unsigned int random_seed);
+                      const std::string &original_json_path,
+                      const std::vector<SamplingJob> &jobs,
+                      const SolverOptions &options);
+
+DdManager *initialize_cudd_manager();
+
+std::shared_ptr<CompiledConstraints>
+compile_components(int num_components, const ComponentBuilder &build_component,
+                   const nlohmann::json &original_variable_list,
+                   const SolverOptions &options);
+
+int sample_compiled_jobs(CompiledConstraints &compiled,
+                         const std::vector<SamplingJob> &jobs,
+                         const SolverOptions &options);
+
+int sample_compiled_constraints(CompiledConstraints &compiled, int num_samples,
+                                const std::string &result_json_path,
+                                unsigned int random_seed,
+                                const SolverOptions &options);
+
+uint64_t hash_content(std::string_view content,
+                      uint64_t hash = 0xcbf29ce484222325ULL);
+
+std::string get_compile_options_key(const SolverOptions &options);
+
+std::shared_ptr<CompiledConstraints> load_or_compile_constraints(
+    const nlohmann::json &data, const std::string &flow,
+    const SolverOptions &options,
+    const std::function<std::shared_ptr<CompiledConstraints>()> &compile);
+
+std::shared_ptr<CompiledConstraints>
+compile_aig_data(const AigData &aig_data,
+                 const nlohmann::json &original_variable_list,
+                 const InputLayout &input_layout, const SolverOptions &options);
+
+std::vector<int>
+determine_bdd_variable_order(const AigData &data,
+                             const std::vector<SupportSet> &var_supports,
+                             const std::vector<int> &output_literals,
+                             const std::vector<bool> &in_cone,
+                             const std::vector<int> &interleaved_bit_order,
+                             const SolverOptions &options);
+
+std::vector<std::vector<int>>
+group_input_order(const std::vector<int> &ordered_inputs,
+                  const InputLayout &input_layout, const std::string &mode);
+
+bool register_variable_groups(
+    DdManager *manager, const std::vector<std::vector<int>> &input_groups);
+
+InputLayout get_input_layout(const nlohmann::json &data);
+
+bool compile_json_to_aig(const nlohmann::json &data, AigData &aig_data);
+
+std::shared_ptr<CompiledConstraints>
+compile_json_constraints(const nlohmann::json &data,
+                         const SolverOptions &options);
+
+int json_aig_solver(const std::string &input_json_path,
+                    const std::vector<SamplingJob> &jobs,
+                    const SolverOptions &options);
+
+int json_bdd_solver(const std::string &input_json_path,
+                    const std::vector<SamplingJob> &jobs,
+                    const SolverOptions &options);
+
+std::vector<std::vector<int>> get_constraint_components_by_dsu_strategy(
+    const std::vector<std::set<int>> &constraint_variable_ids);
+
+bool parse_solver_options(int argc, char *argv[], int first_option_idx,
+                          SolverOptions &options);
+
+int solver_server(const SolverOptions &options);
 
 int json_v_converter(const std::string &input_json_path,
                      const std::string &output_v_dir);
@@ -0,0 +1,210 @@
+#include "nlohmann/json.hpp"
+#include "solver_functions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+using namespace std;
+
+class CompiledConstraintCache {
+  public:
+    explicit CompiledConstraintCache(int max_entries)
+        : capacity(std::max(1, max_entries)) {}
+
+    std::shared_ptr<CompiledConstraints> find(const std::string &key) {
+        auto it = index.find(key);
+        if (it == index.end())
+            return nullptr;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    void insert(const std::string &key,
+                std::shared_ptr<CompiledConstraints> compiled) {
+        entries.emplace_front(key, std::move(compiled));
+        index[key] = entries.begin();
+        while (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+  private:
+    using Entry = std::pair<std::string, std::shared_ptr<CompiledConstraints>>;
+
+    size_t capacity;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+
+static bool has_server_only_options(const std::vector<std::string> &tokens,
+                                    size_t first_option_idx) {
+    for (size_t i = first_option_idx; i < tokens.size(); ++i)
+        if (tokens[i] == "--socket" || tokens[i] == "--cache-size" ||
+            tokens[i] == "--threads")
+            return true;
+    return false;
+}
+
+class SolverServer {
+  public:
+    explicit SolverServer(const SolverOptions &options)
+        : base_options(options), cache(options.server_cache_size) {}
+
+    std::string handle_request(const std::string &line) {
+        std::istringstream line_stream(line);
+        std::vector<std::string> tokens{
+            std::istream_iterator<std::string>(line_stream),
+            std::istream_iterator<std::string>()};
+        if (tokens.size() < 5 || tokens[0] != "sample" ||
+            has_server_only_options(tokens, 5))
+            return "error";
+        std::vector<char *> argv;
+        for (auto &token : tokens)
+            argv.push_back(token.data());
+        SolverOptions options = base_options;
+        int status = 1;
+        try {
+            if (!parse_solver_options(static_cast<int>(argv.size()),
+                                      argv.data(), 5, options))
+                return "error";
+            int num_samples = stoi(tokens[2]);
+            unsigned int random_seed = stoul(tokens[4]);
+            std::shared_ptr<CompiledConstraints> compiled =
+                get_compiled_constraints(tokens[1], options);
+            if (!compiled)
+                return "error";
+            status = sample_compiled_constraints(*compiled, num_samples,
+                                                 tokens[3], random_seed,
+                                                 options);
+        } catch (const std::exception &) {
+            return "error";
+        }
+        return status == 0 ? "ok" : "error";
+    }
+
+  private:
+    SolverOptions base_options;
+    CompiledConstraintCache cache;
+
+    std::shared_ptr<CompiledConstraints>
+    get_compiled_constraints(const std::string &input_json_path,
+                             const SolverOptions &options) {
+        ifstream input_json_stream(input_json_path, ios::binary);
+        if (!input_json_stream.is_open())
+            return nullptr;
+        std::string content{std::istreambuf_iterator<char>(input_json_stream),
+                            std::istreambuf_iterator<char>()};
+        std::string key = std::to_string(hash_content(content)) + ' ' +
+                          get_compile_options_key(options);
+        std::shared_ptr<CompiledConstraints> compiled = cache.find(key);
+        if (compiled)
+            return compiled;
+        json data = json::parse(content, nullptr, false);
+        if (data.is_discarded())
+            return nullptr;
+        compiled = load_or_compile_constraints(data, "aig", options, [&] {
+            return compile_json_constraints(data, options);
+        });
+        if (compiled)
+            cache.insert(key, compiled);
+        return compiled;
+    }
+};
+
+static bool write_response(int fd, const std::string &response) {
+    std::string line = response + '\n';
+    for (size_t written = 0; written < line.size();) {
+        ssize_t n = write(fd, line.data() + written, line.size() - written);
+        if (n <= 0)
+            return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool serve_connection(int fd, SolverServer &server) {
+    std::string pending;
+    char chunk[4096];
+    while (true) {
+        size_t newline = pending.find('\n');
+        if (newline == std::string::npos) {
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n <= 0)
+                return true;
+            pending.append(chunk, n);
+            continue;
+        }
+        std::string line = pending.substr(0, newline);
+        pending.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line == "quit") {
+            write_response(fd, "ok");
+            return false;
+        }
+        if (!write_response(fd, server.handle_request(line)))
+            return true;
+    }
+}
+
+static int serve_socket(const std::string &socket_path, SolverServer &server) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+        return 1;
+    std::strcpy(address.sun_path, socket_path.c_str());
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+        return 1;
+    unlink(socket_path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+        listen(listen_fd, 16) != 0) {
+        close(listen_fd);
+        return 1;
+    }
+    bool running = true;
+    while (running) {
+        int connection_fd = accept(listen_fd, nullptr, nullptr);
+        if (connection_fd < 0 && errno == EINTR)
+            continue;
+        if (connection_fd < 0)
+            break;
+        running = serve_connection(connection_fd, server);
+        close(connection_fd);
+    }
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    return 0;
+}
+
+int solver_server(const SolverOptions &options) {
+    SolverServer server(options);
+    if (!options.server_socket_path.empty())
+        return serve_socket(options.server_socket_path, server);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line == "quit")
+            break;
+        std::cout << server.handle_request(line) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SUPPORT_SET_H
+#define SUPPORT_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+class SupportSet {
+  public:
+    int size() const { return num_inputs; }
+
+    void assign_input(int input_idx) {
+        sparse_inputs.assign(1, input_idx);
+        dense_words.clear();
+        num_inputs = 1;
+    }
+
+    void assign_union(const SupportSet &lhs, const SupportSet &rhs,
+                      int num_words) {
+        if (lhs.dense_words.empty() && rhs.dense_words.empty()) {
+            sparse_inputs.clear();
+            std::set_union(lhs.sparse_inputs.begin(), lhs.sparse_inputs.end(),
+                           rhs.sparse_inputs.begin(), rhs.sparse_inputs.end(),
+                           std::back_inserter(sparse_inputs));
+            num_inputs = sparse_inputs.size();
+            if (num_inputs <= 2 * num_words)
+                return;
+            dense_words.assign(num_words, 0);
+            for (int input_idx : sparse_inputs)
+                dense_words[input_idx / 64] |= 1ULL << (input_idx % 64);
+            sparse_inputs.clear();
+            sparse_inputs.shrink_to_fit();
+            return;
+        }
+        dense_words.assign(num_words, 0);
+        lhs.add_to(dense_words);
+        rhs.add_to(dense_words);
+        sparse_inputs.clear();
+        num_inputs = 0;
+        for (uint64_t word : dense_words)
+            num_inputs += __builtin_popcountll(word);
+    }
+
+    template <typename Fn> void for_each(Fn fn) const {
+        for (int input_idx : sparse_inputs)
+            fn(input_idx);
+        for (size_t w = 0; w < dense_words.size(); ++w)
+            for (uint64_t word = dense_words[w]; word; word &= word - 1)
+                fn(static_cast<int>(64 * w + __builtin_ctzll(word)));
+    }
+
+  private:
+    std::vector<int> sparse_inputs;
+    std::vector<uint64_t> dense_words;
+    int num_inputs = 0;
+
+    void add_to(std::vector<uint64_t> &words) const {
+        for (int input_idx : sparse_inputs)
+            words[input_idx / 64] |= 1ULL << (input_idx % 64);
+        for (size_t w = 0; w < dense_words.size(); ++w)
+            words[w] |= dense_words[w];
+    }
+};
+
+#endif
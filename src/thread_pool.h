@@ -0,0 +1,90 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+  public:
+    explicit ThreadPool(int num_threads) {
+        for (int i = 0; i < std::max(1, num_threads); ++i)
+            workers.emplace_back([this] { worker_loop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cv.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    std::future<void> submit(std::function<void()> task) {
+        auto packaged_task =
+            std::make_shared<std::packaged_task<void()>>(std::move(task));
+        std::future<void> result = packaged_task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            tasks.emplace([packaged_task] { (*packaged_task)(); });
+        }
+        queue_cv.notify_one();
+        return result;
+    }
+
+    void run_all(int num_tasks, const std::function<void(int)> &task) {
+        std::vector<std::future<void>> results;
+        for (int i = 0; i < num_tasks; ++i)
+            results.push_back(submit([&task, i] { task(i); }));
+        std::exception_ptr first_error;
+        for (auto &result : results) {
+            try {
+                result.get();
+            } catch (...) {
+                if (!first_error)
+                    first_error = std::current_exception();
+            }
+        }
+        if (first_error)
+            std::rethrow_exception(first_error);
+    }
+
+  private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stopping = false;
+
+    void worker_loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock,
+                              [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,323 @@
+#include "solver_functions.h"
+#include "support_set.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cudd.h"
+
+static const int FORCE_MAX_ITERATIONS = 64;
+static const unsigned int VARIABLE_GROUP_TYPE = 0; // MTR_DEFAULT
+
+struct OrderingContext {
+    const AigData &data;
+    const std::vector<SupportSet> &var_supports;
+    const std::vector<int> &output_literals;
+    const std::vector<bool> &in_cone;
+    const std::vector<int> &interleaved_bit_order;
+};
+
+struct OrderingEngine {
+    const char *name;
+    std::vector<int> (*order)(const OrderingContext &context);
+};
+
+static std::vector<int> get_depth_first_vars(const OrderingContext &context) {
+    const AigData &data = context.data;
+    std::vector<int> visited_order;
+    std::vector<bool> visited_vars(data.nM + 1, false);
+    std::vector<int> pending_literals(context.output_literals.rbegin(),
+                                      context.output_literals.rend());
+    while (!pending_literals.empty()) {
+        int var = pending_literals.back() / 2;
+        pending_literals.pop_back();
+        if (var == 0 || visited_vars[var])
+            continue;
+        visited_vars[var] = true;
+        visited_order.push_back(var);
+        if (!data.is_and_var[var])
+            continue;
+        int input1_lit = data.and_fanins[2 * var];
+        int input2_lit = data.and_fanins[2 * var + 1];
+        if (context.var_supports[input1_lit / 2].size() <=
+            context.var_supports[input2_lit / 2].size())
+            std::swap(input1_lit, input2_lit);
+        pending_literals.push_back(input1_lit);
+        pending_literals.push_back(input2_lit);
+    }
+    return visited_order;
+}
+
+static std::vector<int> order_by_dfs(const OrderingContext &context) {
+    std::vector<int> ordered_pi_literals;
+    for (int var : get_depth_first_vars(context))
+        if (context.data.input_index_by_var[var] >= 0)
+            ordered_pi_literals.push_back(2 * var);
+    return ordered_pi_literals;
+}
+
+static std::vector<int>
+order_by_input_rank(const OrderingContext &context,
+                    const std::vector<int> &input_rank) {
+    std::vector<int> ordered_pi_literals = order_by_dfs(context);
+    const std::vector<int> &input_index_by_var =
+        context.data.input_index_by_var;
+    std::sort(ordered_pi_literals.begin(), ordered_pi_literals.end(),
+              [&](int lhs_lit, int rhs_lit) {
+                  return input_rank[input_index_by_var[lhs_lit / 2]] <
+                         input_rank[input_index_by_var[rhs_lit / 2]];
+              });
+    return ordered_pi_literals;
+}
+
+static std::vector<int> order_by_declaration(const OrderingContext &context) {
+    std::vector<int> input_rank(context.data.nI);
+    std::iota(input_rank.begin(), input_rank.end(), 0);
+    return order_by_input_rank(context, input_rank);
+}
+
+static std::vector<int> order_by_interleaving(const OrderingContext &context) {
+    int nI = context.data.nI;
+    std::vector<int> input_rank(nI);
+    std::iota(input_rank.begin(), input_rank.end(), nI);
+    for (size_t i = 0; i < context.interleaved_bit_order.size(); ++i) {
+        int input_idx = context.interleaved_bit_order[i];
+        if (input_idx >= 0 && input_idx < nI)
+            input_rank[input_idx] = i;
+    }
+    return order_by_input_rank(context, input_rank);
+}
+
+static long get_total_span(const std::vector<int> &edge_offsets,
+                           const std::vector<int> &edge_vertices,
+                           const std::vector<int> &position) {
+    long total_span = 0;
+    for (size_t e = 0; e + 1 < edge_offsets.size(); ++e) {
+        int min_position = INT_MAX;
+        int max_position = INT_MIN;
+        for (int i = edge_offsets[e]; i < edge_offsets[e + 1]; ++i) {
+            min_position = std::min(min_position, position[edge_vertices[i]]);
+            max_position = std::max(max_position, position[edge_vertices[i]]);
+        }
+        total_span += max_position - min_position;
+    }
+    return total_span;
+}
+
+static std::vector<int> order_by_force(const OrderingContext &context) {
+    const AigData &data = context.data;
+    std::vector<int> vertex_vars = get_depth_first_vars(context);
+    int num_vertices = vertex_vars.size();
+    std::vector<int> vertex_of_var(data.nM + 1, -1);
+    for (int v = 0; v < num_vertices; ++v)
+        vertex_of_var[vertex_vars[v]] = v;
+    std::vector<int> edge_offsets{0};
+    std::vector<int> edge_vertices;
+    std::vector<int> vertex_degree(num_vertices, 0);
+    for (int gate_var : data.and_gate_vars) {
+        if (!context.in_cone[gate_var])
+            continue;
+        edge_vertices.push_back(vertex_of_var[gate_var]);
+        for (int k = 0; k < 2; ++k) {
+            int fanin_var = data.and_fanins[2 * gate_var + k] / 2;
+            if (fanin_var > 0)
+                edge_vertices.push_back(vertex_of_var[fanin_var]);
+        }
+        edge_offsets.push_back(edge_vertices.size());
+    }
+    for (int v : edge_vertices)
+        ++vertex_degree[v];
+    std::vector<int> placement(num_vertices);
+    std::iota(placement.begin(), placement.end(), 0);
+    std::vector<int> position = placement;
+    std::vector<int> best_position = position;
+    long best_span = get_total_span(edge_offsets, edge_vertices, position);
+    std::vector<double> target(num_vertices);
+    for (int iteration = 0; iteration < FORCE_MAX_ITERATIONS; ++iteration) {
+        std::fill(target.begin(), target.end(), 0.0);
+        for (size_t e = 0; e + 1 < edge_offsets.size(); ++e) {
+            double center = 0.0;
+            for (int i = edge_offsets[e]; i < edge_offsets[e + 1]; ++i)
+                center += position[edge_vertices[i]];
+            center /= edge_offsets[e + 1] - edge_offsets[e];
+            for (int i = edge_offsets[e]; i < edge_offsets[e + 1]; ++i)
+                target[edge_vertices[i]] += center;
+        }
+        for (int v = 0; v < num_vertices; ++v)
+            target[v] = vertex_degree[v] ? target[v] / vertex_degree[v]
+                                         : position[v];
+        std::stable_sort(placement.begin(), placement.end(),
+                         [&](int lhs, int rhs) {
+                             return target[lhs] < target[rhs];
+                         });
+        for (int i = 0; i < num_vertices; ++i)
+            position[placement[i]] = i;
+        long span = get_total_span(edge_offsets, edge_vertices, position);
+        if (span >= best_span)
+            break;
+        best_span = span;
+        best_position = position;
+    }
+    std::vector<int> pi_vertices;
+    for (int v = 0; v < num_vertices; ++v)
+        if (data.input_index_by_var[vertex_vars[v]] >= 0)
+            pi_vertices.push_back(v);
+    std::sort(pi_vertices.begin(), pi_vertices.end(), [&](int lhs, int rhs) {
+        return best_position[lhs] < best_position[rhs];
+    });
+    std::vector<int> ordered_pi_literals;
+    for (int v : pi_vertices)
+        ordered_pi_literals.push_back(2 * vertex_vars[v]);
+    return ordered_pi_literals;
+}
+
+static const OrderingEngine ORDERING_ENGINES[] = {
+    {"dfs", order_by_dfs},
+    {"force", order_by_force},
+    {"interleave", order_by_interleaving},
+    {"declaration", order_by_declaration},
+};
+
+static long probe_order_cost(const OrderingContext &context,
+                             const std::vector<int> &ordered_pi_literals,
+                             long node_limit) {
+    const AigData &data = context.data;
+    DdManager *manager =
+        Cudd_Init(0, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0);
+    if (!manager)
+        return LONG_MAX;
+    std::vector<DdNode *> literal_to_bdd_map(2 * (data.nM + 1), nullptr);
+    literal_to_bdd_map[0] = Cudd_ReadLogicZero(manager);
+    literal_to_bdd_map[1] = Cudd_ReadOne(manager);
+    for (int pi_literal : ordered_pi_literals) {
+        DdNode *var_node = Cudd_bddNewVar(manager);
+        if (!var_node) {
+            Cudd_Quit(manager);
+            return LONG_MAX;
+        }
+        literal_to_bdd_map[pi_literal] = var_node;
+        literal_to_bdd_map[pi_literal + 1] = Cudd_Not(var_node);
+    }
+    long remaining_gates = 0;
+    for (int gate_var : data.and_gate_vars)
+        remaining_gates += context.in_cone[gate_var];
+    long cost = 0;
+    for (int gate_var : data.and_gate_vars) {
+        if (!context.in_cone[gate_var])
+            continue;
+        DdNode *input1_bdd = literal_to_bdd_map[data.and_fanins[2 * gate_var]];
+        DdNode *input2_bdd =
+            literal_to_bdd_map[data.and_fanins[2 * gate_var + 1]];
+        DdNode *and_node = input1_bdd && input2_bdd
+                               ? Cudd_bddAnd(manager, input1_bdd, input2_bdd)
+                               : nullptr;
+        if (!and_node)
+            break;
+        Cudd_Ref(and_node);
+        literal_to_bdd_map[2 * gate_var] = and_node;
+        literal_to_bdd_map[2 * gate_var + 1] = Cudd_Not(and_node);
+        --remaining_gates;
+        cost = Cudd_ReadNodeCount(manager);
+        if (cost > node_limit)
+            break;
+    }
+    Cudd_Quit(manager);
+    if (remaining_gates > 0)
+        return node_limit + 1 + remaining_gates;
+    return cost;
+}
+
+std::vector<int>
+determine_bdd_variable_order(const AigData &data,
+                             const std::vector<SupportSet> &var_supports,
+                             const std::vector<int> &output_literals,
+                             const std::vector<bool> &in_cone,
+                             const std::vector<int> &interleaved_bit_order,
+                             const SolverOptions &options) {
+    auto ordering_start_time = std::chrono::high_resolution_clock::now();
+    OrderingContext context{data, var_supports, output_literals, in_cone,
+                            interleaved_bit_order};
+    std::vector<int> best_order;
+    bool found_engine = false;
+    long best_cost = LONG_MAX;
+    std::vector<std::vector<int>> probed_orders;
+    for (const OrderingEngine &engine : ORDERING_ENGINES) {
+        if (options.variable_order != "auto" &&
+            options.variable_order != engine.name)
+            continue;
+        found_engine = true;
+        std::vector<int> order = engine.order(context);
+        if (options.variable_order != "auto") {
+            best_order = order;
+            break;
+        }
+        if (std::find(probed_orders.begin(), probed_orders.end(), order) !=
+            probed_orders.end())
+            continue;
+        long cost = probe_order_cost(
+            context, order,
+            std::min(options.order_probe_node_limit, best_cost));
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_order = order;
+        }
+        probed_orders.push_back(std::move(order));
+    }
+    if (!found_engine)
+        throw std::runtime_error("Unknown variable order: " +
+                                 options.variable_order);
+    auto ordering_end_time = std::chrono::high_resolution_clock::now();
+    auto ordering_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            ordering_end_time - ordering_start_time);
+    return best_order;
+}
+
+std::vector<std::vector<int>>
+group_input_order(const std::vector<int> &ordered_inputs,
+                  const InputLayout &input_layout, const std::string &mode) {
+    const std::vector<InputBit> &input_bits = input_layout.input_bits;
+    std::vector<std::vector<int>> input_groups;
+    std::map<int, int> group_of_key;
+    for (int input_idx : ordered_inputs) {
+        if (mode == "none" ||
+            input_idx >= static_cast<int>(input_bits.size())) {
+            input_groups.push_back({input_idx});
+            continue;
+        }
+        int key = mode == "interleave" ? input_bits[input_idx].word_cluster
+                                       : input_bits[input_idx].variable_id;
+        auto inserted = group_of_key.emplace(key, input_groups.size());
+        if (inserted.second)
+            input_groups.emplace_back();
+        input_groups[inserted.first->second].push_back(input_idx);
+    }
+    for (auto &input_group : input_groups)
+        std::stable_sort(input_group.begin(), input_group.end(),
+                         [&](int lhs, int rhs) {
+                             return mode == "msb"
+                                        ? input_bits[lhs].bit >
+                                              input_bits[rhs].bit
+                                        : input_bits[lhs].bit <
+                                              input_bits[rhs].bit;
+                         });
+    return input_groups;
+}
+
+bool register_variable_groups(
+    DdManager *manager, const std::vector<std::vector<int>> &input_groups) {
+    unsigned int first_index = 0;
+    for (const auto &input_group : input_groups) {
+        if (input_group.size() > 1 &&
+            !Cudd_MakeTreeNode(manager, first_index, input_group.size(),
+                               VARIABLE_GROUP_TYPE))
+            return false;
+        first_index += input_group.size();
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Checks sampled solutions against brute-force enumeration.
+
+Usage: enumeration_test.py <MySolver>
+
+var_0 > var_1 over two 4-bit variables, plus an unconstrained 3-bit var_2,
+has 120 * 8 solutions. Most of them sit on BDD paths that skip levels, so
+asking for more samples than there are solutions must return every one.
+"""
+import itertools
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+INSTANCE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        "gt_free_var.json")
+
+
+def enumerate_solutions():
+    return {(a, b, c)
+            for a, b, c in itertools.product(range(16), range(16), range(8))
+            if a > b}
+
+
+def sample(solver, mode, num_samples, seed, options):
+    with tempfile.TemporaryDirectory() as tmp:
+        result = os.path.join(tmp, "result.json")
+        subprocess.run([solver, mode, INSTANCE, str(num_samples), result,
+                        str(seed)] + options, check=True,
+                       stdout=subprocess.DEVNULL)
+        with open(result) as f:
+            assignments = json.load(f)["assignment_list"]
+    return [tuple(int(v["value"], 16) for v in a) for a in assignments]
+
+
+def main():
+    solver = sys.argv[1]
+    expected = enumerate_solutions()
+    failures = 0
+    for mode in ("solve", "json-to-bdd"):
+        for options in ([], ["--sampler", "walk"],
+                        ["--count-engine", "scaled"]):
+            name = " ".join([mode] + options)
+            everything = sample(solver, mode, 5000, 1, options)
+            if set(everything) != expected or \
+                    len(everything) != len(expected):
+                print(f"FAIL {name}: {len(set(everything))} of "
+                      f"{len(expected)} solutions")
+                failures += 1
+            some = sample(solver, mode, 100, 2, options)
+            if len(some) != 100 or len(set(some)) != 100 or \
+                    not set(some) <= expected:
+                print(f"FAIL {name}: 100 samples not distinct solutions")
+                failures += 1
+    print("PASS" if failures == 0 else f"{failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())